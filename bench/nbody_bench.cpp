@@ -0,0 +1,349 @@
+#include "n_body.hpp"
+#include "initial_conditions.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Harness dei benchmark: calcolo delle forze, step degli integratori, setup (lettura dell'input) e scrittura degli
+// snapshot, su condizioni iniziali sintetiche. I risultati sono scritti in JSON, con lo stesso schema di
+// Google Benchmark ("context" e "benchmarks"), per confrontare le versioni.
+
+using json = nlohmann::json;
+
+// Espone le parti protette del solver usate dai benchmark di setup e output
+template<std::floating_point FP, size_t Dim>
+class BenchNBody : public NBody<FP, Dim> {
+public:
+    using NBody<FP, Dim>::output;
+    using AbstractNbody<FP>::G;
+
+    void set_output_directory(const std::string &directory) {
+        this->output_filename_prefix = directory + "/bench-";
+        this->trajectory_filename = directory + "/bench.traj";
+    }
+};
+
+struct BenchmarkOptions {
+    std::string filter;        // Solo i benchmark il cui nome contiene questa stringa
+    double min_time = 0.5;     // Secondi minimi di misura per benchmark (almeno un'iterazione)
+    size_t max_n = 100000;     // Numero massimo di particelle
+    std::string output = "nbody_bench.json";
+    std::string work_directory = "./output";
+    std::string label;         // Etichetta libera (ad esempio la versione), copiata nel contesto
+    InitialConditions distribution = InitialConditions::PLUMMER; // Particelle dei benchmark di forze e integratori
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t iterations = 0;
+    double real_time = 0.0; // Media per iterazione, ns
+    double cpu_time = 0.0;  // Media per iterazione (tempo CPU del processo, tutti i thread), ns
+    double min_time = 0.0;  // Iterazione più veloce, ns
+    double items_per_second = 0.0;
+};
+
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(const BenchmarkOptions &options) : options(options) {}
+
+    bool selected(const std::string &name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    // Ripete body fino a options.min_time secondi; items è il lavoro di un'iterazione (ad esempio le particelle)
+    void run(const std::string &name, const std::function<void()> &body, double items) {
+        if (!selected(name)) return;
+
+        BenchmarkResult result;
+        result.name = name;
+        result.min_time = std::numeric_limits<double>::infinity();
+        double total = 0.0;
+        const std::clock_t cpu_start = std::clock();
+        do {
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start)
+                    .count();
+            total += elapsed;
+            result.min_time = std::min(result.min_time, elapsed);
+            ++result.iterations;
+        } while (total < options.min_time * 1e9);
+        const double cpu_total = double(std::clock() - cpu_start) / CLOCKS_PER_SEC * 1e9;
+
+        result.real_time = total / double(result.iterations);
+        result.cpu_time = cpu_total / double(result.iterations);
+        result.items_per_second = items / (result.real_time * 1e-9);
+        results.push_back(result);
+
+        std::cout << std::left << std::setw(44) << name << std::right << std::setw(14) << std::fixed
+                  << std::setprecision(3) << result.real_time * 1e-6 << " ms" << std::setw(10) << result.iterations
+                  << std::setw(14) << std::scientific << std::setprecision(3) << result.items_per_second
+                  << " items/s" << std::defaultfloat << std::endl;
+    }
+
+    void write_json(const json &context) const {
+        json report;
+        report["context"] = context;
+        report["benchmarks"] = json::array();
+        for (const auto &result: results) {
+            report["benchmarks"].push_back({{"name", result.name}, {"run_name", result.name},
+                                            {"run_type", "iteration"}, {"iterations", result.iterations},
+                                            {"real_time", result.real_time}, {"cpu_time", result.cpu_time},
+                                            {"min_time", result.min_time}, {"time_unit", "ns"},
+                                            {"items_per_second", result.items_per_second}});
+        }
+
+        std::ofstream file(options.output);
+        if (!file.is_open()) throw std::runtime_error("Error: Unable to open " + options.output);
+        file << report.dump(2) << "\n";
+    }
+
+private:
+    const BenchmarkOptions &options;
+    std::vector<BenchmarkResult> results;
+};
+
+static std::vector<size_t> sizes(size_t min_n, size_t max_n) {
+    std::vector<size_t> out;
+    for (size_t n = min_n; n <= max_n; n *= 10) out.push_back(n);
+    return out;
+}
+
+template<size_t Dim>
+static std::string case_name(const std::string &group, const std::string &variant, size_t n) {
+    return group + "/" + variant + "/" + std::to_string(Dim) + "d/N=" + std::to_string(n);
+}
+
+// Calcolo delle forze per tutti i metodi, sulla distribuzione scelta (default: sfera di Plummer)
+template<size_t Dim>
+static void bench_forces(BenchmarkRunner &runner, const BenchmarkOptions &options) {
+    using FP = double;
+    const FP G = BenchNBody<FP, Dim>::G;
+
+    for (size_t n: sizes(100, options.max_n)) {
+        std::vector<std::pair<std::string, std::unique_ptr<ForceEvaluator<FP, Dim>>>> engines;
+        engines.emplace_back("direct", std::make_unique<DirectForce<FP, Dim>>(G));
+        engines.emplace_back("direct-mixed", std::make_unique<DirectForce<FP, Dim>>(
+                G, PairKernel<FP, Dim>(detect_simd_isa(), KernelPrecision::MIXED)));
+        engines.emplace_back("barnes-hut", std::make_unique<BarnesHutForce<FP, Dim>>(G));
+        engines.emplace_back("fmm", std::make_unique<FmmForce<FP, Dim>>(G));
+        // Gli stessi metodi sulle particelle ordinate lungo la curva di Morton (chiave "reorder_every")
+        engines.emplace_back("barnes-hut-morton", std::make_unique<BarnesHutForce<FP, Dim>>(G));
+        engines.emplace_back("fmm-morton", std::make_unique<FmmForce<FP, Dim>>(G));
+
+        const bool any = std::any_of(engines.begin(), engines.end(), [&](const auto &engine) {
+            return runner.selected(case_name<Dim>("forces", engine.first, n));
+        });
+        if (!any) continue;
+
+        const auto particles = make_initial_conditions<FP, Dim>(options.distribution, n, G);
+        auto sorted = particles;
+        std::vector<uint32_t> order;
+        morton_order(sorted, order);
+        permute(sorted, order);
+
+        VectorField<FP, Dim> forces;
+        forces.resize(n);
+        for (auto &[name, engine]: engines) {
+            const auto &input = name.ends_with("-morton") ? sorted : particles;
+            runner.run(case_name<Dim>("forces", name, n), [&] { engine->compute_forces(input, forces); }, n);
+        }
+    }
+}
+
+// Costo di uno step di ogni integratore, con la somma diretta
+template<size_t Dim>
+static void bench_integrators(BenchmarkRunner &runner, const BenchmarkOptions &options) {
+    using FP = double;
+    const FP G = BenchNBody<FP, Dim>::G;
+
+    for (size_t n: sizes(1000, std::min<size_t>(options.max_n, 10000))) {
+        for (const std::string name: {"euler", "euler-implicit", "leapfrog", "velocity-verlet", "yoshida4"}) {
+            if (!runner.selected(case_name<Dim>("integrator", name, n))) continue;
+
+            auto particles = make_initial_conditions<FP, Dim>(options.distribution, n, G);
+            DirectForce<FP, Dim> evaluator(G);
+            VectorField<FP, Dim> forces;
+            forces.resize(n);
+            evaluator.compute_forces(particles, forces);
+            const auto callback = [&](const ParticleSystem<FP, Dim> &state, VectorField<FP, Dim> &result) {
+                evaluator.compute_forces(state, result);
+            };
+
+            auto integrator = make_integrator<FP, Dim>(name);
+            runner.run(case_name<Dim>("integrator", name, n),
+                       [&] { integrator->integrate(particles, forces, callback, FP(1e-3)); }, n);
+        }
+    }
+}
+
+// File di input JSON nel formato letto da NBody::setup
+template<size_t Dim>
+static void write_input_file(const std::string &file_name, const ParticleSystem<double, Dim> &particles,
+                             const std::string &output_format) {
+    json data;
+    data["N"] = particles.size();
+    data["delta_t"] = 1e-3;
+    data["max_time"] = 1e-3;
+    data["output_format"] = output_format;
+    data["output_queue_depth"] = 0;
+    json list = json::array();
+    for (size_t i = 0; i < particles.size(); ++i) {
+        std::vector<double> position(Dim), velocity(Dim);
+        for (size_t d = 0; d < Dim; ++d) {
+            position[d] = particles.pos()[d][i];
+            velocity[d] = particles.vel()[d][i];
+        }
+        list.push_back({{"mass", particles.mass()[i]}, {"position", position}, {"velocity", velocity}});
+    }
+    data["particles"] = std::move(list);
+
+    std::ofstream file(file_name);
+    if (!file.is_open()) throw std::runtime_error("Error: Unable to open " + file_name);
+    file << data;
+}
+
+// File di input con le particelle in un file binario (particles_file), nella stessa cartella
+template<size_t Dim>
+static void write_particle_input(const std::string &file_name, const std::string &particles_file,
+                                 const ParticleSystem<double, Dim> &particles) {
+    TrajectoryWriter<double, Dim> writer;
+    writer.open(particles_file, particles.size());
+    writer.write_frame(0.0, particles);
+    writer.close();
+
+    json data;
+    data["N"] = particles.size();
+    data["delta_t"] = 1e-3;
+    data["max_time"] = 1e-3;
+    data["particles_file"] = std::filesystem::path(particles_file).filename().string();
+    std::ofstream file(file_name);
+    if (!file.is_open()) throw std::runtime_error("Error: Unable to open " + file_name);
+    file << data;
+}
+
+// Setup (lettura del file JSON o del file binario di particelle) e scrittura di uno snapshot in ogni formato
+template<size_t Dim>
+static void bench_io(BenchmarkRunner &runner, const BenchmarkOptions &options) {
+    using FP = double;
+    const FP G = BenchNBody<FP, Dim>::G;
+    const std::string input_file = options.work_directory + "/bench-input.json";
+    const std::string particles_file = options.work_directory + "/bench-particles.traj";
+
+    for (size_t n: sizes(1000, options.max_n)) {
+        const auto particles = make_initial_conditions<FP, Dim>(InitialConditions::UNIFORM_CUBE, n, G);
+
+        for (const std::string format: {"binary", "csv"}) {
+            const std::string setup_name = case_name<Dim>("setup", "json-" + format, n);
+            const std::string output_name = case_name<Dim>("output", format, n);
+            if (!runner.selected(setup_name) && !runner.selected(output_name)) continue;
+
+            write_input_file<Dim>(input_file, particles, format);
+            BenchNBody<FP, Dim> nbody;
+            nbody.set_output_directory(options.work_directory);
+            nbody.setup(input_file);
+            runner.run(setup_name, [&] { nbody.setup(input_file); }, n);
+
+            // In CSV lo stesso file è riscritto a ogni iterazione, in binario i frame sono accodati alla traiettoria
+            runner.run(output_name, [&] { nbody.output(0); }, n);
+        }
+
+        const std::string particle_file_name = case_name<Dim>("setup", "particle-file", n);
+        if (runner.selected(particle_file_name)) {
+            write_particle_input<Dim>(input_file, particles_file, particles);
+            BenchNBody<FP, Dim> nbody;
+            nbody.set_output_directory(options.work_directory);
+            nbody.setup(input_file);
+            runner.run(particle_file_name, [&] { nbody.setup(input_file); }, n);
+            std::filesystem::remove(particles_file);
+        }
+        std::filesystem::remove(input_file);
+        std::filesystem::remove(options.work_directory + "/bench.traj");
+        std::filesystem::remove(options.work_directory + "/bench-00000.csv");
+    }
+}
+
+static json make_context(const BenchmarkOptions &options) {
+    json context;
+    const std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+    context["date"] = date;
+    context["label"] = options.label;
+    context["simd"] = to_string(detect_simd_isa());
+#ifdef _OPENMP
+    context["model"] = "OPENMP";
+    context["num_threads"] = omp_get_max_threads();
+#elif defined(NBODY_MODEL_MPI)
+    context["model"] = "MPI (serial kernels)";
+    context["num_threads"] = 1;
+#else
+    context["model"] = "SERIAL";
+    context["num_threads"] = 1;
+#endif
+#ifdef NDEBUG
+    context["library_build_type"] = "release";
+#else
+    context["library_build_type"] = "debug";
+#endif
+    context["min_time"] = options.min_time;
+    context["max_n"] = options.max_n;
+    context["distribution"] = to_string(options.distribution);
+    return context;
+}
+
+int main(int argc, char *argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const auto value = [&]() -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+            return argv[++i];
+        };
+        if (arg == "--filter") options.filter = value();
+        else if (arg == "--min-time") options.min_time = std::stod(value());
+        else if (arg == "--max-n") options.max_n = std::stoul(value());
+        else if (arg == "--output") options.output = value();
+        else if (arg == "--work-dir") options.work_directory = value();
+        else if (arg == "--label") options.label = value();
+        else if (arg == "--distribution") options.distribution = parse_initial_conditions(value());
+        else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--min-time <seconds>] [--max-n <N>]"
+                      << " [--output <file.json>] [--work-dir <directory>] [--label <text>]"
+                      << " [--distribution plummer|uniform-cube|disk]" << std::endl;
+            return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    std::filesystem::create_directories(options.work_directory);
+    const json context = make_context(options);
+    std::cout << "nbody_bench: " << context["model"].get<std::string>() << ", " << context["num_threads"]
+              << " thread(s), " << context["simd"].get<std::string>() << " kernel\n";
+    std::cout << std::left << std::setw(44) << "benchmark" << std::right << std::setw(17) << "time/iter"
+              << std::setw(10) << "iters" << std::setw(22) << "throughput" << "\n";
+
+    BenchmarkRunner runner(options);
+    bench_forces<2>(runner, options);
+    bench_forces<3>(runner, options);
+    bench_integrators<2>(runner, options);
+    bench_integrators<3>(runner, options);
+    bench_io<2>(runner, options);
+    bench_io<3>(runner, options);
+
+    runner.write_json(context);
+    std::cout << "Results written to '" << options.output << "'\n";
+    return EXIT_SUCCESS;
+}
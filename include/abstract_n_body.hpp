@@ -1,37 +1,37 @@
 #ifndef TEAM_05_NBODY_NBODY_H
 #define TEAM_05_NBODY_NBODY_H
 
+#include "particle_system.hpp"
+#include "trajectory.hpp"
+#include "diagnostics.hpp"
+#include "checkpoint.hpp"
+#include "json.hpp"
 #include <fstream>
 #include <vector>
 #include <cmath>
 #include <stdexcept>
+#include <string>
 
 #define DEF_OUTPUT_FILENAME_PREFIX "./output/nbody-"
+#define DEF_TRAJECTORY_FILENAME "./output/nbody.traj"
+#define DEF_DIAGNOSTICS_FILENAME "./output/diagnostics" // Estensione secondo il formato
+
+// Messaggi stampati su std::cout durante la simulazione (errori e avvisi sono sempre scritti su std::cerr)
+enum class Verbosity {
+    QUIET,  // Nessuno
+    NORMAL, // Configurazione all'avvio e riepilogo finale
+    VERBOSE // Anche l'avanzamento di ogni step
+};
 
-template<std::floating_point FP>
-struct Particle {
-    FP mass; // Rimuovi 'const' per permettere il costruttore predefinito
-    std::vector<FP> pos;
-    std::vector<FP> vel;
-
-    // Costruttore predefinito
-    Particle() : mass(0.0), pos(), vel() {}
-
-    // Costruttore parametrizzato
-    Particle(FP m, const std::vector<FP> &p, const std::vector<FP> &v)
-            : mass(m), pos(p), vel(v) {
-        if (p.size() != v.size()) {
-            throw std::invalid_argument("Position and velocity vectors must have the same size");
-        }
-    }
+inline Verbosity parse_verbosity(const std::string &verbosity) {
+    if (verbosity == "quiet") return Verbosity::QUIET;
+    if (verbosity == "normal") return Verbosity::NORMAL;
+    if (verbosity == "verbose") return Verbosity::VERBOSE;
+    throw std::invalid_argument("Unknown verbosity: " + verbosity);
+}
 
-    friend std::ostream &operator<<(std::ostream &stream, const Particle &particle) {
-        stream << "m=" << particle.mass << " ";
-        for (size_t d = 0; d < particle.pos.size(); ++d) stream << "x" << d << "=" << particle.pos[d] << " ";
-        for (size_t d = 0; d < particle.vel.size(); ++d) stream << "v" << d << "=" << particle.vel[d] << " ";
-        return stream;
-    }
-};
+// Costante di gravitazione universale (unità SI), comune a tutti i solver
+inline constexpr double gravitational_constant = 6.673e-11;
 
 template<std::floating_point FP>
 class AbstractNbody {
@@ -42,21 +42,58 @@ public:
 
     virtual void solve() = 0;
 
+    // Riprende la simulazione da un checkpoint, dopo setup (che legge la configurazione) e prima di solve
+    virtual void restart(const std::string &checkpoint_file) = 0;
+
+    // Chiavi che sostituiscono quelle del file di input letto da setup (opzioni da riga di comando)
+    void set_overrides(nlohmann::json config) { overrides = std::move(config); }
+
 protected:
     AbstractNbody(unsigned int num_particles, FP dt)
-            : N(num_particles), delta_t(dt), particles(num_particles) {}
+            : N(num_particles), delta_t(dt) {}
 
     virtual void output(size_t step) = 0;
 
-    static constexpr FP G = 6.673e-11;
+    // La precisione è scelta prima di setup leggendo il file solo fino alla prima particella: una chiave
+    // "precision" successiva a "particles" non è stata vista e, se non corrisponde all'istanza, è un errore
+    static void check_precision(const nlohmann::json &data) {
+        if (!data.contains("precision")) return;
+        const std::string precision = data["precision"];
+        if (precision != "double" && precision != "float") {
+            throw std::invalid_argument("Unknown precision: " + precision);
+        }
+        if (precision != (sizeof(FP) == sizeof(float) ? "float" : "double")) {
+            throw std::invalid_argument("\"precision\": \"" + precision +
+                                        "\" must precede \"particles\" in the input file");
+        }
+    }
+
+    static constexpr FP G = gravitational_constant;
 
     unsigned int N = 0;
     FP delta_t = 0.0;
     FP t_max = 0.0;
-    std::vector<Particle<FP>> particles;
     std::vector<FP> time;
 
     std::string output_filename_prefix = DEF_OUTPUT_FILENAME_PREFIX;
+    std::string trajectory_filename = DEF_TRAJECTORY_FILENAME;
+    std::string diagnostics_filename = DEF_DIAGNOSTICS_FILENAME;
+    std::string checkpoint_filename = DEF_CHECKPOINT_FILENAME;
+
+    OutputFormat output_format = OutputFormat::BINARY;
+    size_t output_every = 1; // Uno snapshot ogni output_every step
+    size_t output_queue_depth = 2; // Buffer della scrittura asincrona della traiettoria (0: sincrona)
+
+    DiagnosticsFormat diagnostics_format = DiagnosticsFormat::CSV;
+    size_t diagnostics_every = 1; // Una misura delle grandezze conservate ogni diagnostics_every step (0: nessuna)
+
+    size_t checkpoint_every = 0; // Un checkpoint ogni checkpoint_every step e alla fine (0: nessuno)
+    size_t start_step = 0;       // Primo step da integrare: diverso da 0 dopo restart
+
+    nlohmann::json overrides = nlohmann::json::object();
+    Verbosity verbosity = Verbosity::NORMAL;
+
+    bool logs(Verbosity level) const { return verbosity >= level; }
 
 };
 
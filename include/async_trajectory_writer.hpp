@@ -0,0 +1,140 @@
+#ifndef TEAM_05_NBODY_ASYNC_TRAJECTORY_WRITER_HPP
+#define TEAM_05_NBODY_ASYNC_TRAJECTORY_WRITER_HPP
+
+#include "trajectory.hpp"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Scrittura della traiettoria in un thread dedicato: il solver copia lo stato in uno dei queue_depth buffer
+// del pool e prosegue, mentre il thread di I/O scrive i frame in ordine. Se tutti i buffer sono in coda,
+// write_frame attende che uno si liberi (backpressure). Con queue_depth = 0 la scrittura è sincrona.
+template<std::floating_point FP, size_t Dim>
+class AsyncTrajectoryWriter {
+public:
+    AsyncTrajectoryWriter() = default;
+
+    AsyncTrajectoryWriter(const AsyncTrajectoryWriter &) = delete;
+
+    AsyncTrajectoryWriter &operator=(const AsyncTrajectoryWriter &) = delete;
+
+    ~AsyncTrajectoryWriter() {
+        try {
+            close();
+        } catch (...) {
+            // Un errore di scrittura non segnalato prima della distruzione viene perso
+        }
+    }
+
+    // Con resume_frames riprende una traiettoria esistente dopo i suoi primi resume_frames frame
+    void open(const std::string &file_name, size_t num_particles, size_t queue_depth,
+              std::optional<uint64_t> resume_frames = std::nullopt) {
+        if (resume_frames) writer.resume(file_name, num_particles, *resume_frames);
+        else writer.open(file_name, num_particles);
+        buffers.assign(queue_depth, aligned_vector<FP>(writer.frame_size()));
+        free_buffers.clear();
+        ready_buffers.clear();
+        for (size_t b = 0; b < queue_depth; ++b) free_buffers.push_back(b);
+        stopping = false;
+        error = nullptr;
+        stalls = 0;
+        if (queue_depth > 0) thread = std::thread(&AsyncTrajectoryWriter::run, this);
+    }
+
+    bool is_open() const { return writer.is_open(); }
+
+    void write_frame(FP time, const ParticleSystem<FP, Dim> &particles) {
+        if (buffers.empty()) return writer.write_frame(time, particles);
+
+        size_t buffer;
+        {
+            std::unique_lock lock(mutex);
+            if (free_buffers.empty()) ++stalls;
+            buffer_free.wait(lock, [this] { return !free_buffers.empty() || error; });
+            if (error) std::rethrow_exception(error);
+            buffer = free_buffers.front();
+            free_buffers.pop_front();
+        }
+
+        TrajectoryWriter<FP, Dim>::pack_frame(time, particles, buffers[buffer].data());
+
+        {
+            std::lock_guard lock(mutex);
+            ready_buffers.push_back(buffer);
+        }
+        buffer_ready.notify_one();
+    }
+
+    // Attende la scrittura dei frame in coda, senza chiudere il file (prima di un checkpoint)
+    void flush() {
+        std::unique_lock lock(mutex);
+        buffer_free.wait(lock, [this] { return free_buffers.size() == buffers.size() || error; });
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Attende la scrittura dei frame in coda e chiude il file
+    void close() {
+        if (thread.joinable()) {
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+            buffer_ready.notify_one();
+            thread.join();
+        }
+        if (writer.is_open()) writer.close();
+        if (error) std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+    // Numero di frame per cui il solver ha atteso un buffer libero
+    size_t stall_count() const { return stalls; }
+
+private:
+    TrajectoryWriter<FP, Dim> writer;
+    std::vector<aligned_vector<FP>> buffers; // Pool di buffer, ciascuno con un frame
+    std::deque<size_t> free_buffers;  // Buffer disponibili per il solver
+    std::deque<size_t> ready_buffers; // Buffer da scrivere, in ordine di step
+    std::mutex mutex;
+    std::condition_variable buffer_free;
+    std::condition_variable buffer_ready;
+    bool stopping = false;
+    std::exception_ptr error;
+    size_t stalls = 0;
+    std::thread thread;
+
+    void run() {
+        while (true) {
+            size_t buffer;
+            {
+                std::unique_lock lock(mutex);
+                buffer_ready.wait(lock, [this] { return !ready_buffers.empty() || stopping; });
+                if (ready_buffers.empty()) return; // stopping, coda vuota
+                buffer = ready_buffers.front();
+                ready_buffers.pop_front();
+            }
+
+            try {
+                NBODY_PROFILE_SCOPE("trajectory write");
+                writer.write_packed_frame(buffers[buffer].data());
+            } catch (...) {
+                std::lock_guard lock(mutex);
+                error = std::current_exception();
+                buffer_free.notify_all();
+                return;
+            }
+
+            {
+                std::lock_guard lock(mutex);
+                free_buffers.push_back(buffer);
+            }
+            buffer_free.notify_one();
+        }
+    }
+};
+
+#endif // TEAM_05_NBODY_ASYNC_TRAJECTORY_WRITER_HPP
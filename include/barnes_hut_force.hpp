@@ -0,0 +1,115 @@
+#ifndef TEAM_05_NBODY_BARNES_HUT_FORCE_HPP
+#define TEAM_05_NBODY_BARNES_HUT_FORCE_HPP
+
+#include "force_evaluator.hpp"
+#include "interaction.hpp"
+#include "orthant_tree.hpp"
+#include <sstream>
+
+// Metodo di Barnes-Hut O(N log N): le particelle sono organizzate in un albero con 2^Dim figli per nodo
+// (quadtree in 2D, octree in 3D) e le celle abbastanza lontane, secondo l'angolo di apertura theta,
+// sono approssimate con il loro centro di massa.
+// L'albero è ricostruito a ogni step; il ciclo sulle particelle bersaglio
+// è definito nel sorgente del modello scelto (src/serial, src/openmp).
+// La legge di interazione (interaction.hpp) vale sia per le celle lontane sia per le particelle vicine.
+template<std::floating_point FP, size_t Dim>
+class BarnesHutForce : public ForceEvaluator<FP, Dim> {
+public:
+    BarnesHutForce(FP G, FP theta = 0.5, size_t leaf_size = 8, const Interaction &interaction = {})
+            : G(G), theta(theta), leaf_size(leaf_size), interaction(interaction) {
+        if (theta < 0) throw std::invalid_argument("The opening angle theta must be non-negative");
+        if (leaf_size == 0) throw std::invalid_argument("The leaf size must be positive");
+    }
+
+    void compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) override;
+
+    void compute_active_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                               const std::vector<uint32_t> &active) override;
+
+    std::string name() const override {
+        std::ostringstream stream;
+        stream << "barnes-hut (theta = " << theta << ", leaf size = " << leaf_size;
+        if (interaction.softening != Softening::NONE) stream << ", " << interaction.name();
+        stream << ")";
+        return stream.str();
+    }
+
+private:
+    using Tree = OrthantTree<FP, Dim>;
+    using Node = typename Tree::Node;
+
+    FP G;
+    FP theta;
+    size_t leaf_size;
+    Interaction interaction;
+    Tree tree;
+
+    // Forza agente sulla particella i, percorrendo l'albero dalla radice; accumula in potential_i
+    // la somma di G m_i m_j phi(r) sulle stesse interazioni (celle lontane e particelle vicine)
+    template<typename Law>
+    Vec<FP, Dim> walk(const Law &law, const std::array<const FP *, Dim> &pos, const FP *mass, uint32_t i,
+                      FP &potential_i) const;
+};
+
+template<std::floating_point FP, size_t Dim>
+template<typename Law>
+Vec<FP, Dim> BarnesHutForce<FP, Dim>::walk(const Law &law, const std::array<const FP *, Dim> &pos, const FP *mass,
+                                           uint32_t i, FP &potential_i) const {
+    Vec<FP, Dim> force{};
+    Vec<FP, Dim> pos_i;
+    for (size_t d = 0; d < Dim; ++d) pos_i[d] = pos[d][i];
+    const FP g_mass_i = G * mass[i];
+    const FP theta_squared = theta * theta;
+
+    const auto &nodes = tree.nodes();
+    const auto &order = tree.order();
+
+    std::array<uint32_t, Tree::max_depth * Tree::num_orthants + 1> stack;
+    size_t top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node &node = nodes[stack[--top]];
+
+        Vec<FP, Dim> diff;
+        FP dist_squared = 0.0;
+        bool contains = true;
+        for (size_t d = 0; d < Dim; ++d) {
+            diff[d] = node.com[d] - pos_i[d];
+            dist_squared += diff[d] * diff[d];
+            contains = contains && std::abs(pos_i[d] - node.center[d]) <= node.half_size;
+        }
+
+        // Cella lontana, che non contiene i: approssimazione di monopolo
+        const FP size = 2 * node.half_size;
+        if (!contains && size * size < theta_squared * dist_squared) {
+            FP factor, pair_potential;
+            law(g_mass_i * node.mass, dist_squared, factor, pair_potential);
+            potential_i += pair_potential;
+            for (size_t d = 0; d < Dim; ++d) force[d] += factor * diff[d];
+        } else if (node.is_leaf()) {
+            // Foglia vicina: interazioni dirette
+            for (uint32_t k = node.begin; k < node.end; ++k) {
+                const uint32_t j = order[k];
+                if (j == i) continue;
+                FP r_squared = 0.0;
+                Vec<FP, Dim> r;
+                for (size_t d = 0; d < Dim; ++d) {
+                    r[d] = pos[d][j] - pos_i[d];
+                    r_squared += r[d] * r[d];
+                }
+                if (r_squared == 0) continue;
+                FP factor, pair_potential;
+                law(g_mass_i * mass[j], r_squared, factor, pair_potential);
+                potential_i += pair_potential;
+                for (size_t d = 0; d < Dim; ++d) force[d] += factor * r[d];
+            }
+        } else {
+            for (uint32_t c = 0; c < node.child_count; ++c) stack[top++] = node.first_child + c;
+        }
+    }
+
+    return force;
+}
+
+#endif // TEAM_05_NBODY_BARNES_HUT_FORCE_HPP
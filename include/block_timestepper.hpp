@@ -0,0 +1,226 @@
+#ifndef TEAM_05_NBODY_BLOCK_TIMESTEPPER_HPP
+#define TEAM_05_NBODY_BLOCK_TIMESTEPPER_HPP
+
+#include "integrator.hpp"
+#include "checkpoint.hpp"
+#include "spatial_order.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <ostream>
+#include <sstream>
+
+// Passi temporali individuali a blocchi: la particella i avanza con passo delta_t / 2^level_i, con level_i in
+// [0, max_level], usando il leapfrog kick-drift-kick. Le posizioni di tutte le particelle sono avanzate fino al
+// successivo istante di sincronizzazione, ma le forze sono ricalcolate solo per le particelle attive, il cui passo
+// termina in quell'istante. Alla fine di ogni passo delta_t tutte le particelle sono sincronizzate.
+// Il passo desiderato segue il criterio di Aarseth semplificato dt = eta |a| / |da/dt|, con la derivata
+// dell'accelerazione stimata dalle ultime due valutazioni delle forze della particella. Un livello può diventare
+// più fine in ogni momento, più grossolano (di un solo livello) solo se l'istante è allineato al passo doppio.
+template<std::floating_point FP, size_t Dim>
+class BlockTimestepper {
+public:
+    // Ricalcola le forze sulle particelle attive nelle posizioni correnti
+    using ActiveForceCallback = std::function<void(const ParticleSystem<FP, Dim> &, VectorField<FP, Dim> &,
+                                                   const std::vector<uint32_t> &)>;
+
+    BlockTimestepper(size_t max_level = 8, FP accuracy = 0.05) : max_level(max_level), accuracy(accuracy) {
+        if (max_level > 30) throw std::invalid_argument("The maximum timestep level must be at most 30");
+        if (accuracy <= 0) throw std::invalid_argument("The timestep accuracy must be positive");
+        level_steps.assign(max_level + 1, 0);
+    }
+
+    // Avanza di delta_t, il passo del livello 0. Come per Integrator, all'ingresso forces contiene le forze di
+    // tutte le particelle nelle posizioni correnti e all'uscita quelle nelle nuove posizioni.
+    void advance(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                 const ActiveForceCallback &compute_forces, FP delta_t);
+
+    std::string name() const {
+        std::ostringstream stream;
+        stream << "block leapfrog (max level = " << max_level << ", eta = " << accuracy << ")";
+        return stream.str();
+    }
+
+    // Statistiche per livello: passi completati e valutazioni delle forze
+    void report(std::ostream &stream, FP delta_t) const;
+
+    // Stato per il checkpoint: livelli, accelerazioni dell'ultima valutazione e statistiche
+    void save_state(CheckpointWriter &checkpoint) const;
+
+    void load_state(CheckpointReader &checkpoint);
+
+    // Segue il riordinamento delle particelle (spatial_order.hpp): livelli e accelerazioni sono per particella
+    void permute(const std::vector<uint32_t> &order) {
+        if (levels.size() != order.size()) return;
+        ::permute(levels.data(), order);
+        ::permute(previous_accel, order);
+    }
+
+private:
+    size_t max_level;
+    FP accuracy;
+
+    std::vector<uint8_t> levels;         // Livello corrente di ogni particella
+    std::vector<uint64_t> next_tick;     // Fine del passo corrente, in unità di delta_t / 2^max_level
+    VectorField<FP, Dim> previous_accel; // Accelerazione all'ultima valutazione delle forze
+    std::vector<uint32_t> active;
+    std::vector<FP> kick_dt;
+
+    uint64_t force_calls = 0;         // Chiamate al calcolo delle forze
+    uint64_t force_evaluations = 0;   // Forze calcolate su singole particelle
+    uint64_t big_steps = 0;           // Passi delta_t completati
+    std::vector<uint64_t> level_steps; // Passi completati per livello
+
+    uint64_t ticks(size_t level) const { return uint64_t(1) << (max_level - level); }
+
+    // Nuovo livello della particella i, attiva all'istante tick, con le forze appena calcolate
+    uint8_t choose_level(const ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces, uint32_t i,
+                         uint64_t tick, FP delta_t);
+};
+
+template<std::floating_point FP, size_t Dim>
+void BlockTimestepper<FP, Dim>::advance(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                                        const ActiveForceCallback &compute_forces, FP delta_t) {
+    const size_t n = particles.size();
+    const uint64_t end_tick = ticks(0);
+    const FP tick_dt = delta_t / FP(end_tick);
+
+    // Al primo passo la storia delle accelerazioni non è disponibile: si parte dal livello più fine
+    if (levels.size() != n) {
+        levels.assign(n, static_cast<uint8_t>(max_level));
+        previous_accel.resize(n);
+        for (size_t d = 0; d < Dim; ++d)
+            for (size_t i = 0; i < n; ++i) previous_accel[d][i] = forces[d][i] / particles.mass()[i];
+    }
+
+    // Kick di apertura di tutte le particelle, sincronizzate all'inizio del passo
+    active.resize(n);
+    kick_dt.resize(n);
+    next_tick.resize(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        active[i] = i;
+        kick_dt[i] = tick_dt * FP(ticks(levels[i])) / 2;
+        next_tick[i] = ticks(levels[i]);
+    }
+    kick_active(particles, forces, active, kick_dt);
+
+    uint64_t tick = 0;
+    while (tick < end_tick) {
+        // Drift di tutte le particelle fino al successivo istante di sincronizzazione
+        const uint64_t next = *std::min_element(next_tick.begin(), next_tick.end());
+        drift(particles, tick_dt * FP(next - tick));
+        tick = next;
+
+        active.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (next_tick[i] == tick) active.push_back(i);
+        compute_forces(particles, forces, active);
+        ++force_calls;
+        force_evaluations += active.size();
+
+        // Kick di chiusura con il vecchio passo e, se il passo delta_t non è finito, di apertura con il nuovo
+        kick_dt.resize(active.size());
+        for (size_t k = 0; k < active.size(); ++k) {
+            const uint32_t i = active[k];
+            ++level_steps[levels[i]];
+            const uint8_t level = choose_level(particles, forces, i, tick, delta_t);
+            kick_dt[k] = tick_dt * FP(ticks(levels[i])) / 2;
+            if (tick < end_tick) kick_dt[k] += tick_dt * FP(ticks(level)) / 2;
+            levels[i] = level;
+            next_tick[i] = tick + ticks(level);
+        }
+        kick_active(particles, forces, active, kick_dt);
+    }
+    ++big_steps;
+}
+
+template<std::floating_point FP, size_t Dim>
+uint8_t BlockTimestepper<FP, Dim>::choose_level(const ParticleSystem<FP, Dim> &particles,
+                                                const VectorField<FP, Dim> &forces, uint32_t i, uint64_t tick,
+                                                FP delta_t) {
+    const size_t level = levels[i];
+    const FP old_dt = delta_t * FP(ticks(level)) / FP(ticks(0));
+
+    FP accel_squared = 0.0, jerk_squared = 0.0;
+    for (size_t d = 0; d < Dim; ++d) {
+        const FP accel = forces[d][i] / particles.mass()[i];
+        const FP jerk = (accel - previous_accel[d][i]) / old_dt;
+        accel_squared += accel * accel;
+        jerk_squared += jerk * jerk;
+        previous_accel[d][i] = accel;
+    }
+
+    // Livello desiderato: il più grossolano con passo non superiore a eta |a| / |da/dt|
+    size_t desired = 0;
+    if (jerk_squared > 0) {
+        const FP desired_dt = accuracy * std::sqrt(accel_squared / jerk_squared);
+        if (desired_dt < delta_t) {
+            desired = static_cast<size_t>(std::min<FP>(std::ceil(std::log2(delta_t / desired_dt)), FP(max_level)));
+        }
+    }
+
+    if (desired > level) return static_cast<uint8_t>(desired);
+    if (desired < level && tick % (2 * ticks(level)) == 0) return static_cast<uint8_t>(level - 1);
+    return static_cast<uint8_t>(level);
+}
+
+template<std::floating_point FP, size_t Dim>
+void BlockTimestepper<FP, Dim>::save_state(CheckpointWriter &checkpoint) const {
+    const size_t n = levels.size();
+    checkpoint.write_value(uint64_t(max_level));
+    checkpoint.write_value(uint64_t(n));
+    checkpoint.write(levels.data(), n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.write(previous_accel[d], n);
+    checkpoint.write_value(force_calls);
+    checkpoint.write_value(force_evaluations);
+    checkpoint.write_value(big_steps);
+    checkpoint.write(level_steps.data(), level_steps.size());
+}
+
+template<std::floating_point FP, size_t Dim>
+void BlockTimestepper<FP, Dim>::load_state(CheckpointReader &checkpoint) {
+    if (checkpoint.read_value<uint64_t>() != max_level) {
+        throw std::invalid_argument("The checkpoint was written with a different maximum timestep level");
+    }
+    const auto n = static_cast<size_t>(checkpoint.read_value<uint64_t>());
+    levels.resize(n);
+    previous_accel.resize(n);
+    checkpoint.read(levels.data(), n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.read(previous_accel[d], n);
+    force_calls = checkpoint.read_value<uint64_t>();
+    force_evaluations = checkpoint.read_value<uint64_t>();
+    big_steps = checkpoint.read_value<uint64_t>();
+    checkpoint.read(level_steps.data(), level_steps.size());
+}
+
+template<std::floating_point FP, size_t Dim>
+void BlockTimestepper<FP, Dim>::report(std::ostream &stream, FP delta_t) const {
+    size_t finest = 0;
+    uint64_t total_steps = 0;
+    for (size_t level = 0; level <= max_level; ++level) {
+        if (level_steps[level] > 0) finest = level;
+        total_steps += level_steps[level];
+    }
+
+    stream << "Block timesteps: " << big_steps << " steps of " << delta_t << ", " << force_calls
+           << " force computations, " << force_evaluations << " particle force evaluations\n";
+    stream << std::setw(6) << "level" << std::setw(14) << "dt" << std::setw(16) << "particle steps" << std::setw(10)
+           << "share" << "\n";
+    for (size_t level = 0; level <= finest; ++level) {
+        stream << std::setw(6) << level << std::setw(14) << delta_t / FP(ticks(0) / ticks(level))
+               << std::setw(16) << level_steps[level] << std::setw(9) << std::fixed << std::setprecision(1)
+               << (total_steps > 0 ? 100.0 * double(level_steps[level]) / double(total_steps) : 0.0) << "%"
+               << std::defaultfloat << std::setprecision(6) << "\n";
+    }
+
+    // Confronto con un passo globale pari a quello del livello più fine usato
+    if (!levels.empty() && force_evaluations > 0) {
+        const double global = double(levels.size()) * double(big_steps) * double(uint64_t(1) << finest);
+        stream << "A global step of " << delta_t / FP(uint64_t(1) << finest) << " would need " << global
+               << " particle force evaluations (" << std::setprecision(3) << global / double(force_evaluations)
+               << "x)" << std::setprecision(6) << "\n";
+    }
+}
+
+#endif // TEAM_05_NBODY_BLOCK_TIMESTEPPER_HPP
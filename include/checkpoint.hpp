@@ -0,0 +1,293 @@
+#ifndef TEAM_05_NBODY_CHECKPOINT_HPP
+#define TEAM_05_NBODY_CHECKPOINT_HPP
+
+#include "particle_system.hpp"
+#include "spatial_order.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+#define DEF_CHECKPOINT_FILENAME "./output/nbody.chk"
+
+// Header del file di checkpoint (128 byte, little-endian). Segue il payload, nell'ordine in cui il solver lo
+// scrive: x[0..Dim)[0..N), v[0..Dim)[0..N), m[0..N), F[0..Dim)[0..N), poi le sezioni di stato (descrizione
+// della configurazione, passi a blocchi, ordine delle particelle dalla versione 2, diagnostica). Le forze sono
+// salvate perché gli integratori riusano la valutazione finale di uno step all'inizio del successivo: ricalcolarle
+// non darebbe gli stessi bit con i calcoli paralleli. Gli integratori a passo fisso non hanno altro stato tra uno
+// step e l'altro.
+struct CheckpointHeader {
+    char magic[8];          // "NBODYCHK"
+    uint32_t version;
+    uint32_t dimensions;
+    uint64_t num_particles;
+    uint32_t scalar_bytes;  // sizeof(FP)
+    uint32_t header_bytes;
+    uint64_t step;          // Step completati
+    double time;            // Tempo simulato alla fine dell'ultimo step
+    double delta_t;
+    uint64_t payload_bytes;
+    uint64_t checksum;      // Del payload (CheckpointHash)
+    uint8_t reserved[56];
+};
+
+static_assert(sizeof(CheckpointHeader) == 128, "The checkpoint header must be 128 bytes long");
+
+template<std::floating_point FP, size_t Dim>
+CheckpointHeader make_checkpoint_header(size_t num_particles, uint64_t step, FP time, FP delta_t) {
+    CheckpointHeader header{};
+    std::memcpy(header.magic, "NBODYCHK", sizeof(header.magic));
+    header.version = 2;
+    header.dimensions = Dim;
+    header.num_particles = num_particles;
+    header.scalar_bytes = sizeof(FP);
+    header.header_bytes = sizeof(CheckpointHeader);
+    header.step = step;
+    header.time = static_cast<double>(time);
+    header.delta_t = static_cast<double>(delta_t);
+    return header;
+}
+
+// Hash FNV-1a a parole di 64 bit: rileva checkpoint troncati o corrotti a costo trascurabile rispetto alla
+// scrittura. Il risultato non dipende da come il flusso è diviso tra le chiamate a update (i byte di una
+// parola incompleta attendono la chiamata successiva).
+class CheckpointHash {
+public:
+    void update(const void *data, size_t bytes) {
+        const auto *input = static_cast<const unsigned char *>(data);
+        if (pending_bytes > 0) {
+            const size_t missing = std::min(bytes, sizeof(pending) - pending_bytes);
+            std::memcpy(pending + pending_bytes, input, missing);
+            pending_bytes += missing;
+            input += missing;
+            bytes -= missing;
+            if (pending_bytes < sizeof(pending)) return;
+            mix(pending);
+            pending_bytes = 0;
+        }
+        for (; bytes >= sizeof(pending); input += sizeof(pending), bytes -= sizeof(pending)) mix(input);
+        std::memcpy(pending, input, bytes);
+        pending_bytes += bytes;
+    }
+
+    uint64_t value() const {
+        uint64_t result = hash;
+        for (size_t k = 0; k < pending_bytes; ++k) result = (result ^ pending[k]) * prime;
+        return result;
+    }
+
+private:
+    static constexpr uint64_t prime = 0x100000001b3ull;
+    uint64_t hash = 0xcbf29ce484222325ull;
+    unsigned char pending[8];
+    size_t pending_bytes = 0;
+
+    void mix(const unsigned char *word_bytes) {
+        uint64_t word;
+        std::memcpy(&word, word_bytes, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+};
+
+// Scrittura atomica: il payload va in file_name.tmp, che dopo fsync sostituisce file_name con una rename.
+// Un'interruzione in qualunque momento lascia quindi intatto il checkpoint precedente.
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(const std::string &file_name)
+            : file_name(file_name), temporary_name(file_name + ".tmp") {
+        file = std::fopen(temporary_name.c_str(), "wb");
+        if (!file) throw std::runtime_error("Error: Unable to open the checkpoint file " + temporary_name);
+        // Spazio per l'header, scritto da commit quando payload e checksum sono noti
+        const CheckpointHeader placeholder{};
+        put(&placeholder, sizeof(placeholder));
+    }
+
+    CheckpointWriter(const CheckpointWriter &) = delete;
+
+    CheckpointWriter &operator=(const CheckpointWriter &) = delete;
+
+    ~CheckpointWriter() {
+        if (file) {
+            std::fclose(file);
+            std::remove(temporary_name.c_str());
+        }
+    }
+
+    template<typename T>
+    void write(const T *data, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        checksum.update(data, count * sizeof(T));
+        payload_bytes += count * sizeof(T);
+        put(data, count * sizeof(T));
+    }
+
+    template<typename T>
+    void write_value(const T &value) { write(&value, 1); }
+
+    void write_string(const std::string &value) {
+        write_value(uint64_t(value.size()));
+        write(value.data(), value.size());
+    }
+
+    // Completa l'header, lo scrive in testa, rende il file persistente e lo rinomina
+    void commit(CheckpointHeader header) {
+        header.payload_bytes = payload_bytes;
+        header.checksum = checksum.value();
+        if (std::fseek(file, 0, SEEK_SET) != 0) fail();
+        put(&header, sizeof(header));
+        if (std::fflush(file) != 0 || fsync(fileno(file)) != 0) fail();
+        std::fclose(std::exchange(file, nullptr));
+        if (std::rename(temporary_name.c_str(), file_name.c_str()) != 0) {
+            std::remove(temporary_name.c_str());
+            throw std::runtime_error("Error: Unable to replace the checkpoint file " + file_name);
+        }
+    }
+
+private:
+    std::string file_name, temporary_name;
+    std::FILE *file = nullptr;
+    uint64_t payload_bytes = 0;
+    CheckpointHash checksum;
+
+    void put(const void *data, size_t bytes) {
+        if (bytes > 0 && std::fwrite(data, 1, bytes, file) != bytes) fail();
+    }
+
+    [[noreturn]] void fail() const {
+        throw std::runtime_error("Error: Unable to write the checkpoint file " + temporary_name);
+    }
+};
+
+// Lettura di un checkpoint: l'header e il checksum del payload sono verificati all'apertura
+class CheckpointReader {
+public:
+    explicit CheckpointReader(const std::string &file_name) : file_name(file_name) {
+        file = std::fopen(file_name.c_str(), "rb");
+        if (!file) throw std::runtime_error("Error: Unable to open the checkpoint file " + file_name);
+        if (std::fread(&file_header, sizeof(file_header), 1, file) != 1 ||
+            std::memcmp(file_header.magic, "NBODYCHK", sizeof(file_header.magic)) != 0) {
+            close_and_throw("is not a checkpoint");
+        }
+        if (file_header.version < 1 || file_header.version > 2) close_and_throw("has an unsupported version");
+        if (std::filesystem::file_size(file_name) != file_header.header_bytes + file_header.payload_bytes) {
+            close_and_throw("is truncated");
+        }
+
+        // Verifica del checksum in una prima passata a blocchi
+        std::vector<char> block(1 << 20);
+        CheckpointHash checksum;
+        for (uint64_t left = file_header.payload_bytes; left > 0;) {
+            const size_t bytes = static_cast<size_t>(std::min<uint64_t>(left, block.size()));
+            if (std::fread(block.data(), 1, bytes, file) != bytes) close_and_throw("cannot be read");
+            checksum.update(block.data(), bytes);
+            left -= bytes;
+        }
+        if (checksum.value() != file_header.checksum) close_and_throw("is corrupted (checksum mismatch)");
+        std::fseek(file, static_cast<long>(file_header.header_bytes), SEEK_SET);
+    }
+
+    CheckpointReader(const CheckpointReader &) = delete;
+
+    CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+    ~CheckpointReader() {
+        if (file) std::fclose(file);
+    }
+
+    const CheckpointHeader &header() const { return file_header; }
+
+    // Verifica che il checkpoint sia stato scritto per un problema con la stessa dimensione, precisione e passo
+    template<std::floating_point FP, size_t Dim>
+    void check(FP delta_t) const {
+        if (file_header.dimensions != Dim || file_header.scalar_bytes != sizeof(FP)) {
+            throw std::invalid_argument("The checkpoint " + file_name + " describes a " +
+                                        std::to_string(file_header.dimensions) + "D problem with " +
+                                        std::to_string(8 * file_header.scalar_bytes) + "-bit values");
+        }
+        if (file_header.delta_t != static_cast<double>(delta_t)) {
+            throw std::invalid_argument("The checkpoint " + file_name + " was written with delta_t = " +
+                                        std::to_string(file_header.delta_t));
+        }
+    }
+
+    template<typename T>
+    void read(T *data, size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (count > 0 && std::fread(data, sizeof(T), count, file) != count) {
+            throw std::runtime_error("Error: Unexpected end of the checkpoint file " + file_name);
+        }
+    }
+
+    template<typename T>
+    T read_value() {
+        T value;
+        read(&value, 1);
+        return value;
+    }
+
+    std::string read_string() {
+        std::string value(read_value<uint64_t>(), '\0');
+        read(value.data(), value.size());
+        return value;
+    }
+
+private:
+    std::string file_name;
+    std::FILE *file = nullptr;
+    CheckpointHeader file_header{};
+
+    [[noreturn]] void close_and_throw(const std::string &reason) {
+        std::fclose(std::exchange(file, nullptr));
+        throw std::runtime_error("Error: The file " + file_name + " " + reason);
+    }
+};
+
+// Stato delle particelle e forze correnti, all'inizio del payload
+template<std::floating_point FP, size_t Dim>
+void write_particle_state(CheckpointWriter &checkpoint, const ParticleSystem<FP, Dim> &particles,
+                          const VectorField<FP, Dim> &forces) {
+    const size_t n = particles.size();
+    for (size_t d = 0; d < Dim; ++d) checkpoint.write(particles.pos()[d], n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.write(particles.vel()[d], n);
+    checkpoint.write(particles.mass(), n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.write(forces[d], n);
+}
+
+// Legge lo stato scritto da write_particle_state; particles e forces sono ridimensionati secondo l'header
+template<std::floating_point FP, size_t Dim>
+void read_particle_state(CheckpointReader &checkpoint, ParticleSystem<FP, Dim> &particles,
+                         VectorField<FP, Dim> &forces) {
+    const auto n = static_cast<size_t>(checkpoint.header().num_particles);
+    particles = ParticleSystem<FP, Dim>(n);
+    forces.resize(n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.read(particles.pos()[d], n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.read(particles.vel()[d], n);
+    checkpoint.read(particles.mass(), n);
+    for (size_t d = 0; d < Dim; ++d) checkpoint.read(forces[d], n);
+}
+
+// Ordine delle particelle: ids[i] è l'indice nel file di input della particella in posizione i dello stato
+// salvato (vuoto se le particelle sono nell'ordine del file). Assente nei checkpoint della versione 1.
+inline void write_particle_order(CheckpointWriter &checkpoint, const std::vector<uint32_t> &ids) {
+    checkpoint.write_value(uint64_t(ids.size()));
+    checkpoint.write(ids.data(), ids.size());
+}
+
+inline std::vector<uint32_t> read_particle_order(CheckpointReader &checkpoint) {
+    if (checkpoint.header().version < 2) return {};
+    std::vector<uint32_t> ids(static_cast<size_t>(checkpoint.read_value<uint64_t>()));
+    checkpoint.read(ids.data(), ids.size());
+    if (ids.size() != 0 && ids.size() != checkpoint.header().num_particles) {
+        throw std::runtime_error("Error: The particle order of the checkpoint is inconsistent");
+    }
+    return ids;
+}
+
+#endif // TEAM_05_NBODY_CHECKPOINT_HPP
@@ -0,0 +1,216 @@
+#ifndef TEAM_05_NBODY_DIAGNOSTICS_HPP
+#define TEAM_05_NBODY_DIAGNOSTICS_HPP
+
+#include "particle_system.hpp"
+#include "checkpoint.hpp"
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Grandezze conservate del sistema. Sono tutte somme sulle particelle, quindi si possono ridurre tra i rank;
+// l'energia potenziale è quella accumulata dal calcolo delle forze nelle stesse posizioni.
+template<std::floating_point FP, size_t Dim>
+struct Diagnostics {
+    // Piani (a, b), a < b, delle componenti del momento angolare: 0 in 1D, 1 in 2D (z), 3 in 3D (xy, xz, yz)
+    static constexpr size_t num_planes = Dim * (Dim - 1) / 2;
+
+    FP kinetic_energy = 0.0;
+    FP potential_energy = 0.0;
+    FP mass = 0.0;
+    Vec<FP, Dim> momentum{};                       // sum m v
+    std::array<FP, num_planes> angular_momentum{}; // L_ab = sum m (x_a v_b - x_b v_a)
+    Vec<FP, Dim> mass_moment{};                    // sum m x
+
+    FP total_energy() const { return kinetic_energy + potential_energy; }
+
+    Vec<FP, Dim> center_of_mass() const {
+        Vec<FP, Dim> center;
+        for (size_t d = 0; d < Dim; ++d) center[d] = mass_moment[d] / mass;
+        return center;
+    }
+
+    // Tutte le somme in un unico array, per le riduzioni tra rank
+    static constexpr size_t num_values = 3 + 2 * Dim + num_planes;
+
+    std::array<FP, num_values> values() const {
+        std::array<FP, num_values> out;
+        size_t k = 0;
+        out[k++] = kinetic_energy;
+        out[k++] = potential_energy;
+        out[k++] = mass;
+        for (size_t d = 0; d < Dim; ++d) out[k++] = momentum[d];
+        for (size_t p = 0; p < num_planes; ++p) out[k++] = angular_momentum[p];
+        for (size_t d = 0; d < Dim; ++d) out[k++] = mass_moment[d];
+        return out;
+    }
+
+    static Diagnostics from_values(const std::array<FP, num_values> &in) {
+        Diagnostics out;
+        size_t k = 0;
+        out.kinetic_energy = in[k++];
+        out.potential_energy = in[k++];
+        out.mass = in[k++];
+        for (size_t d = 0; d < Dim; ++d) out.momentum[d] = in[k++];
+        for (size_t p = 0; p < num_planes; ++p) out.angular_momentum[p] = in[k++];
+        for (size_t d = 0; d < Dim; ++d) out.mass_moment[d] = in[k++];
+        return out;
+    }
+};
+
+// Variazione dell'energia totale rispetto alla misura initial: relativa, oppure assoluta se l'energia iniziale è
+// nulla (ad esempio un solo corpo fermo), così che il valore sia sempre finito
+template<std::floating_point FP, size_t Dim>
+FP energy_change(const Diagnostics<FP, Dim> &initial, const Diagnostics<FP, Dim> &current) {
+    const FP change = std::abs(current.total_energy() - initial.total_energy());
+    return initial.total_energy() != 0 ? change / std::abs(initial.total_energy()) : change;
+}
+
+// Somme O(N) delle grandezze cinematiche; potential_energy è copiata nel risultato
+// (definita nel sorgente del modello scelto: src/serial, src/openmp)
+template<std::floating_point FP, size_t Dim>
+Diagnostics<FP, Dim> measure_diagnostics(const ParticleSystem<FP, Dim> &particles, FP potential_energy);
+
+// Formato del flusso di diagnostica
+enum class DiagnosticsFormat {
+    CSV,       // Una riga per misura, con header
+    JSON_LINES // Un oggetto JSON per riga
+};
+
+inline DiagnosticsFormat parse_diagnostics_format(const std::string &format) {
+    if (format == "csv") return DiagnosticsFormat::CSV;
+    if (format == "jsonl") return DiagnosticsFormat::JSON_LINES;
+    throw std::invalid_argument("Unknown diagnostics format: " + format);
+}
+
+inline std::string diagnostics_extension(DiagnosticsFormat format) {
+    return format == DiagnosticsFormat::CSV ? ".csv" : ".jsonl";
+}
+
+// Scrittura delle misure: energia e sue variazioni relative, quantità di moto, momento angolare e
+// spostamento del centro di massa rispetto alla prima misura
+template<std::floating_point FP, size_t Dim>
+class DiagnosticsWriter {
+public:
+    void open(const std::string &file_name, DiagnosticsFormat diagnostics_format) {
+        format = diagnostics_format;
+        file.open(file_name, std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error: Unable to open the diagnostics file " + file_name);
+        }
+        file.precision(std::numeric_limits<FP>::max_digits10);
+        has_initial = false;
+        max_relative_change = 0.0;
+
+        if (format == DiagnosticsFormat::CSV) write_header();
+    }
+
+    // Stato per il checkpoint: misure di riferimento e lunghezza del file scritto finora (0 se chiuso)
+    void save_state(CheckpointWriter &checkpoint) {
+        file.flush();
+        checkpoint.write_value(uint64_t(file.is_open() ? static_cast<uint64_t>(file.tellp()) : 0));
+        checkpoint.write_value(uint8_t(has_initial));
+        checkpoint.write_value(max_relative_change);
+        checkpoint.write_value(initial.values());
+        checkpoint.write_value(last.values());
+    }
+
+    // Riprende il flusso dal checkpoint: le righe scritte dopo il checkpoint sono scartate e le variazioni
+    // continuano a riferirsi alla prima misura della simulazione
+    void resume(const std::string &file_name, DiagnosticsFormat diagnostics_format, CheckpointReader &checkpoint) {
+        const auto bytes = checkpoint.read_value<uint64_t>();
+        const bool checkpoint_initial = checkpoint.read_value<uint8_t>() != 0;
+        const FP checkpoint_max_change = checkpoint.read_value<FP>();
+        const auto initial_values = checkpoint.read_value<std::array<FP, Diagnostics<FP, Dim>::num_values>>();
+        const auto last_values = checkpoint.read_value<std::array<FP, Diagnostics<FP, Dim>::num_values>>();
+
+        if (bytes == 0 || !std::filesystem::exists(file_name) || std::filesystem::file_size(file_name) < bytes) {
+            open(file_name, diagnostics_format); // Flusso non disponibile: si riparte con un nuovo file
+        } else {
+            std::filesystem::resize_file(file_name, bytes);
+            format = diagnostics_format;
+            file.open(file_name, std::ios::app);
+            if (!file.is_open()) {
+                throw std::runtime_error("Error: Unable to open the diagnostics file " + file_name);
+            }
+            file.precision(std::numeric_limits<FP>::max_digits10);
+        }
+        has_initial = checkpoint_initial;
+        max_relative_change = checkpoint_max_change;
+        initial = Diagnostics<FP, Dim>::from_values(initial_values);
+        last = Diagnostics<FP, Dim>::from_values(last_values);
+    }
+
+    bool is_open() const { return file.is_open(); }
+
+    void write(size_t step, FP time, const Diagnostics<FP, Dim> &diagnostics) {
+        if (!has_initial) {
+            initial = diagnostics;
+            has_initial = true;
+        }
+        last = diagnostics;
+
+        const FP relative_change = energy_change(initial, diagnostics);
+        max_relative_change = std::max(max_relative_change, relative_change);
+
+        const Vec<FP, Dim> center = diagnostics.center_of_mass(), initial_center = initial.center_of_mass();
+        FP drift = 0.0;
+        for (size_t d = 0; d < Dim; ++d) drift += (center[d] - initial_center[d]) * (center[d] - initial_center[d]);
+        drift = std::sqrt(drift);
+
+        if (format == DiagnosticsFormat::CSV) {
+            file << step << "," << time << "," << diagnostics.kinetic_energy << "," << diagnostics.potential_energy
+                 << "," << diagnostics.total_energy() << "," << relative_change;
+            for (size_t d = 0; d < Dim; ++d) file << "," << diagnostics.momentum[d];
+            for (size_t p = 0; p < Diagnostics<FP, Dim>::num_planes; ++p)
+                file << "," << diagnostics.angular_momentum[p];
+            for (size_t d = 0; d < Dim; ++d) file << "," << center[d];
+            file << "," << drift << "\n";
+        } else {
+            file << "{\"step\":" << step << ",\"t\":" << time << ",\"kinetic\":" << diagnostics.kinetic_energy
+                 << ",\"potential\":" << diagnostics.potential_energy << ",\"energy\":" << diagnostics.total_energy()
+                 << ",\"relative_energy_change\":" << relative_change;
+            write_array("momentum", diagnostics.momentum.data(), Dim);
+            write_array("angular_momentum", diagnostics.angular_momentum.data(), Diagnostics<FP, Dim>::num_planes);
+            write_array("center_of_mass", center.data(), Dim);
+            file << ",\"com_drift\":" << drift << "}\n";
+        }
+        if (!file) throw std::runtime_error("Error: Unable to write the diagnostics!");
+    }
+
+    void close() { file.close(); }
+
+    // Riepilogo delle misure scritte
+    const Diagnostics<FP, Dim> &first() const { return initial; }
+
+    const Diagnostics<FP, Dim> &latest() const { return last; }
+
+    FP max_relative_energy_change() const { return max_relative_change; }
+
+private:
+    std::ofstream file;
+    DiagnosticsFormat format = DiagnosticsFormat::CSV;
+    Diagnostics<FP, Dim> initial, last;
+    bool has_initial = false;
+    FP max_relative_change = 0.0;
+
+    void write_header() {
+        file << "step,t,kinetic,potential,energy,relative_energy_change";
+        for (size_t d = 0; d < Dim; ++d) file << ",p" << d;
+        for (size_t a = 0; a < Dim; ++a)
+            for (size_t b = a + 1; b < Dim; ++b) file << ",L" << a << b;
+        for (size_t d = 0; d < Dim; ++d) file << ",com" << d;
+        file << ",com_drift\n";
+    }
+
+    void write_array(const char *key, const FP *values, size_t count) {
+        file << ",\"" << key << "\":[";
+        for (size_t k = 0; k < count; ++k) file << (k > 0 ? "," : "") << values[k];
+        file << "]";
+    }
+};
+
+#endif // TEAM_05_NBODY_DIAGNOSTICS_HPP
@@ -0,0 +1,80 @@
+#ifndef TEAM_05_NBODY_DIRECT_FORCE_HPP
+#define TEAM_05_NBODY_DIRECT_FORCE_HPP
+
+#include "force_evaluator.hpp"
+#include "pair_kernel.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+
+// Byte di un blocco di sorgenti della somma diretta (posizioni, masse e reazioni): il blocco resta nella cache L2
+// mentre tutte le righe lo attraversano, invece di essere riletto dalla memoria per ogni riga
+constexpr size_t direct_tile_bytes = size_t(1) << 18;
+
+// Sorgenti per blocco, multiplo della larghezza dei registri AVX-512 in float
+template<std::floating_point FP, size_t Dim>
+constexpr size_t direct_tile_size() {
+    return std::max<size_t>(64, direct_tile_bytes / ((2 * Dim + 1) * sizeof(FP)) / 64 * 64);
+}
+
+// Somma diretta O(N^2) su tutte le coppie, calcolata con il kernel vettoriale a blocchi di sorgenti
+// (il ciclo sulle righe è definito nel sorgente del modello scelto: src/serial, src/openmp)
+template<std::floating_point FP, size_t Dim>
+class DirectForce : public ForceEvaluator<FP, Dim> {
+public:
+    DirectForce(FP G, PairKernel<FP, Dim> kernel = PairKernel<FP, Dim>())
+            : G(G), kernel(kernel) {}
+
+    void compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) override;
+
+    void compute_active_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                               const std::vector<uint32_t> &active) override;
+
+    std::string name() const override {
+        const Interaction &interaction = kernel.interaction_law();
+        return "direct (" + to_string(kernel.isa()) +
+               (kernel.precision() == KernelPrecision::MIXED ? " mixed-precision" : "") + " kernel" +
+               (interaction.softening == Softening::NONE ? "" : ", " + interaction.name()) + ")";
+    }
+
+private:
+    FP G;
+    PairKernel<FP, Dim> kernel;
+    std::vector<FP> thread_forces; // Buffer privati dei thread (solo OpenMP)
+};
+
+// Errore e tempo dei kernel in precisione ridotta e mista rispetto a quello in precisione piena
+template<std::floating_point FP, size_t Dim>
+void kernel_precision_report(const ParticleSystem<FP, Dim> &particles, FP G, const Interaction &interaction,
+                             std::ostream &stream) {
+    using clock = std::chrono::steady_clock;
+    const SimdIsa isa = detect_simd_isa();
+    VectorField<FP, Dim> reference(particles.size()), forces(particles.size());
+
+    auto start = clock::now();
+    DirectForce<FP, Dim>(G, PairKernel<FP, Dim>(isa, KernelPrecision::FULL, interaction))
+            .compute_forces(particles, reference);
+    const double full_time = std::chrono::duration<double>(clock::now() - start).count();
+
+    stream << "Direct kernel precision report (N = " << particles.size() << ", " << to_string(isa)
+           << ", full precision: " << full_time << " s)\n";
+    stream << std::setw(10) << "precision" << std::setw(14) << "mean rel err" << std::setw(14) << "max rel err"
+           << std::setw(14) << "global err" << std::setw(12) << "time [s]" << std::setw(10) << "speedup" << "\n";
+    for (const auto &[label, precision]: {std::pair{"reduced", KernelPrecision::REDUCED},
+                                          std::pair{"mixed", KernelPrecision::MIXED}}) {
+        DirectForce<FP, Dim> direct(G, PairKernel<FP, Dim>(isa, precision, interaction));
+        start = clock::now();
+        direct.compute_forces(particles, forces);
+        const double time = std::chrono::duration<double>(clock::now() - start).count();
+
+        const ForceError error = compare_forces(reference, forces);
+        stream << std::setw(10) << label << std::setw(14) << error.mean_relative << std::setw(14)
+               << error.max_relative << std::setw(14) << error.global << std::setw(12) << time << std::setw(10)
+               << full_time / time << "\n";
+    }
+}
+
+#endif // TEAM_05_NBODY_DIRECT_FORCE_HPP
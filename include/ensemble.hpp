@@ -0,0 +1,258 @@
+#ifndef TEAM_05_NBODY_ENSEMBLE_HPP
+#define TEAM_05_NBODY_ENSEMBLE_HPP
+
+#include "abstract_n_body.hpp"
+#include "integrator_factory.hpp"
+#include "force_evaluator_factory.hpp"
+#include "block_timestepper.hpp"
+#include "diagnostics.hpp"
+#include "input_reader.hpp"
+#include "work_stealing_pool.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Insieme (ensemble) di simulazioni indipendenti di sistemi piccoli, eseguite in un unico processo: ogni file di
+// input è letto una sola volta e ogni sistema è integrato per intero da un thread, senza file per step. Le
+// simulazioni sono distribuite con un WorkStealingPool, dalla più costosa, e i risultati sono raccolti in un
+// riepilogo (una riga per sistema) e in un file con gli stati finali di tutti i sistemi.
+// Della configurazione di ogni file sono usate le chiavi del modello fisico e numerico (delta_t, max_time,
+// integratore, passi a blocchi, softening, metodo delle forze); quelle di output, checkpoint e thread sono ignorate.
+
+// File di input dell'ensemble: i file .json di una cartella, in ordine alfabetico, oppure quelli elencati in un
+// manifest, uno per riga (righe vuote e commenti "#" ignorati), con percorsi relativi alla cartella del manifest
+inline std::vector<std::string> list_ensemble_inputs(const std::string &path) {
+    std::vector<std::string> inputs;
+    if (std::filesystem::is_directory(path)) {
+        for (const auto &entry: std::filesystem::directory_iterator(path)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".json") {
+                inputs.push_back(entry.path().string());
+            }
+        }
+        std::sort(inputs.begin(), inputs.end());
+    } else {
+        std::ifstream manifest(path);
+        if (!manifest.is_open()) throw std::runtime_error("Error: Unable to open the manifest " + path);
+        const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+        std::string line;
+        while (std::getline(manifest, line)) {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (line.empty() || line[0] == '#') continue;
+            inputs.push_back((directory / line).string());
+        }
+    }
+    if (inputs.empty()) throw std::runtime_error("Error: No input files in " + path);
+    return inputs;
+}
+
+// Campo di una riga CSV, tra virgolette se contiene separatori o virgolette
+inline std::string csv_field(const std::string &value) {
+    if (value.find_first_of(",\"\n") == std::string::npos) return value;
+    std::string quoted = "\"";
+    for (char c: value) quoted += c == '"' ? std::string("\"\"") : std::string(1, c);
+    return quoted + "\"";
+}
+
+// Un sistema dell'ensemble: configurazione e particelle del file di input, poi stato finale e misure
+template<std::floating_point FP, size_t Dim>
+struct EnsembleMember {
+    std::string input_file;
+    nlohmann::json config;
+    ParticleSystem<FP, Dim> particles; // Stato iniziale, poi finale
+    FP delta_t = 0.0;
+    size_t steps = 0; // Come in NBody: un passo per ogni istante in [0, max_time]
+
+    std::string error; // Vuoto se la simulazione è terminata
+    Diagnostics<FP, Dim> initial, latest;
+    FP max_relative_energy_change = 0.0;
+    double wall_time = 0.0; // Lettura esclusa, s
+
+    // Interazioni tra coppie calcolate, per ordinare i sistemi dal più costoso
+    double cost() const { return double(particles.size()) * double(particles.size()) * double(steps); }
+
+    void load(const nlohmann::json &overrides) {
+        config = read_input(input_file, particles);
+        config.update(overrides);
+        delta_t = config.at("delta_t").template get<FP>();
+        const FP t_max = config.at("max_time").template get<FP>();
+        if (!(delta_t > 0)) throw std::invalid_argument("delta_t must be positive");
+        steps = 1;
+        for (FP t = delta_t; t <= t_max; t += delta_t) ++steps;
+    }
+
+    void simulate();
+};
+
+template<std::floating_point FP, size_t Dim>
+void EnsembleMember<FP, Dim>::simulate() {
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::unique_ptr<Integrator<FP, Dim>> integrator = make_integrator<FP, Dim>(config.value("integrator",
+                                                                                                  "euler"));
+    std::unique_ptr<BlockTimestepper<FP, Dim>> block_timestepper;
+    if (config.value("block_timesteps", false)) {
+        if (config.value("integrator", "leapfrog") != "leapfrog") {
+            throw std::invalid_argument("Block timesteps require the leapfrog integrator");
+        }
+        block_timestepper = std::make_unique<BlockTimestepper<FP, Dim>>(config.value("max_timestep_level", size_t(8)),
+                                                                        config.value("timestep_accuracy", FP(0.05)));
+    }
+    const Interaction interaction(parse_softening(config.value("softening", "none")),
+                                  config.value("softening_length", 0.0));
+    const std::unique_ptr<ForceEvaluator<FP, Dim>> force_evaluator =
+            make_force_evaluator<FP, Dim>(config, FP(gravitational_constant), interaction);
+
+    VectorField<FP, Dim> forces(particles.size()), all_forces;
+    const auto force_callback = [&](const ParticleSystem<FP, Dim> &state, VectorField<FP, Dim> &result) {
+        force_evaluator->compute_forces(state, result);
+    };
+    const auto active_force_callback = [&](const ParticleSystem<FP, Dim> &state, VectorField<FP, Dim> &result,
+                                           const std::vector<uint32_t> &active) {
+        force_evaluator->compute_active_forces(state, result, active);
+    };
+
+    // L'energia potenziale è quella dell'ultimo calcolo delle forze; dopo un passo a blocchi che non ha
+    // ricalcolato tutte le particelle si valutano le forze di tutte, in un campo a parte
+    const auto measure = [&] {
+        if (!force_evaluator->potential_energy()) {
+            all_forces.resize(particles.size());
+            force_evaluator->compute_forces(particles, all_forces);
+        }
+        return measure_diagnostics(particles, *force_evaluator->potential_energy());
+    };
+
+    const size_t diagnostics_every = config.value("diagnostics_every", size_t(1));
+    force_evaluator->compute_forces(particles, forces);
+    initial = latest = measure();
+    for (size_t step = 0; step < steps; ++step) {
+        if (block_timestepper) block_timestepper->advance(particles, forces, active_force_callback, delta_t);
+        else integrator->integrate(particles, forces, force_callback, delta_t);
+
+        if (step + 1 == steps || (diagnostics_every > 0 && (step + 1) % diagnostics_every == 0)) {
+            latest = measure();
+            max_relative_energy_change = std::max(max_relative_energy_change, energy_change(initial, latest));
+        }
+    }
+    wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<std::floating_point FP, size_t Dim>
+class Ensemble {
+public:
+    Ensemble(const std::vector<std::string> &input_files, nlohmann::json overrides)
+            : members(input_files.size()), overrides(std::move(overrides)) {
+        for (size_t k = 0; k < members.size(); ++k) members[k].input_file = input_files[k];
+    }
+
+    // Legge tutti i file di input, poi integra i sistemi dal più costoso. Un errore in un sistema (file non
+    // valido, configurazione non supportata) è registrato nel riepilogo e non interrompe gli altri.
+    void run(WorkStealingPool &pool) {
+        std::vector<size_t> jobs(members.size());
+        std::iota(jobs.begin(), jobs.end(), 0);
+        pool.run(jobs, [this](size_t job, size_t) {
+            guarded(members[job], [this](auto &member) { member.load(overrides); });
+        });
+
+        std::stable_sort(jobs.begin(), jobs.end(), [this](size_t a, size_t b) {
+            return members[a].cost() > members[b].cost();
+        });
+        pool.run(jobs, [this](size_t job, size_t) {
+            // I sistemi sono piccoli: con OpenMP ogni thread del pool calcola le forze da solo
+#ifdef _OPENMP
+            omp_set_num_threads(1);
+#endif
+            if (members[job].error.empty()) guarded(members[job], [](auto &member) { member.simulate(); });
+        });
+    }
+
+    size_t size() const { return members.size(); }
+
+    size_t failures() const {
+        return std::count_if(members.begin(), members.end(), [](const auto &member) { return !member.error.empty(); });
+    }
+
+    // Somma delle durate delle simulazioni, s
+    double simulation_time() const {
+        double total = 0.0;
+        for (const auto &member: members) total += member.wall_time;
+        return total;
+    }
+
+    // Una riga per sistema, nell'ordine dei file di input
+    void write_summary(const std::string &file_name) const {
+        std::ofstream file(file_name);
+        if (!file.is_open()) throw std::runtime_error("Error: Unable to open the ensemble summary " + file_name);
+        file << std::setprecision(std::numeric_limits<FP>::max_digits10);
+        file << "system,input,status,N,steps,t,initial_energy,final_energy,max_relative_energy_change,"
+                "com_drift,wall_time\n";
+        for (size_t k = 0; k < members.size(); ++k) {
+            const EnsembleMember<FP, Dim> &member = members[k];
+            file << k << "," << csv_field(member.input_file) << ","
+                 << csv_field(member.error.empty() ? "ok" : member.error) << "," << member.particles.size() << ","
+                 << member.steps << ",";
+            if (!member.error.empty()) {
+                file << ",,,,,\n";
+                continue;
+            }
+            const Vec<FP, Dim> center = member.latest.center_of_mass();
+            const Vec<FP, Dim> initial_center = member.initial.center_of_mass();
+            FP drift = 0.0;
+            for (size_t d = 0; d < Dim; ++d) drift += (center[d] - initial_center[d]) * (center[d] - initial_center[d]);
+            file << FP(member.steps) * member.delta_t << "," << member.initial.total_energy() << ","
+                 << member.latest.total_energy() << "," << member.max_relative_energy_change << ","
+                 << std::sqrt(drift) << "," << member.wall_time << "\n";
+        }
+        if (!file) throw std::runtime_error("Error: Unable to write the ensemble summary " + file_name);
+    }
+
+    // Stati finali dei sistemi terminati, una riga per particella, con l'indice del sistema nel riepilogo
+    void write_final_states(const std::string &file_name) const {
+        std::ofstream file(file_name);
+        if (!file.is_open()) throw std::runtime_error("Error: Unable to open the ensemble states " + file_name);
+        file << std::setprecision(std::numeric_limits<FP>::max_digits10);
+        file << "system,particle";
+        for (size_t d = 0; d < Dim; ++d) file << ",x" << d;
+        for (size_t d = 0; d < Dim; ++d) file << ",v" << d;
+        file << ",m\n";
+        for (size_t k = 0; k < members.size(); ++k) {
+            if (!members[k].error.empty()) continue;
+            const ParticleSystem<FP, Dim> &particles = members[k].particles;
+            for (size_t i = 0; i < particles.size(); ++i) {
+                file << k << "," << i;
+                for (size_t d = 0; d < Dim; ++d) file << "," << particles.pos()[d][i];
+                for (size_t d = 0; d < Dim; ++d) file << "," << particles.vel()[d][i];
+                file << "," << particles.mass()[i] << "\n";
+            }
+        }
+        if (!file) throw std::runtime_error("Error: Unable to write the ensemble states " + file_name);
+    }
+
+private:
+    std::vector<EnsembleMember<FP, Dim>> members;
+    nlohmann::json overrides;
+
+    template<typename Function>
+    static void guarded(EnsembleMember<FP, Dim> &member, Function &&function) {
+        try {
+            function(member);
+        } catch (const std::exception &e) {
+            member.error = e.what();
+        }
+    }
+};
+
+#endif // TEAM_05_NBODY_ENSEMBLE_HPP
@@ -3,23 +3,21 @@
 
 #include "integrator.hpp"
 
-// Implementazione del metodo di Eulero esplicito
-template<std::floating_point FP>
-class EulerExplicitIntegrator : public Integrator<FP> {
-    void integrate(std::vector<Particle<FP>>& particles, const std::vector<std::vector<FP>>& forces, FP delta_t) override {
-        for (size_t i = 0; i < particles.size(); ++i) {
-            for (size_t d = 0; d < particles[i].pos.size(); ++d) {
-                // Aggiorna velocità usando le forze
-                particles[i].vel[d] += delta_t * forces[i][d] / particles[i].mass;
-                // Aggiorna posizione usando la velocità aggiornata
-                particles[i].pos[d] += delta_t * particles[i].vel[d];
-            }
-        }
+// Implementazione del metodo di Eulero esplicito, nella forma simplettica: prima la velocità, poi la posizione
+// con la velocità aggiornata. Una valutazione delle forze per step, accuratezza del primo ordine.
+template<std::floating_point FP, size_t Dim>
+class EulerExplicitIntegrator : public Integrator<FP, Dim> {
+public:
+    void integrate(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                   const typename Integrator<FP, Dim>::ForceCallback &compute_forces, FP delta_t) override {
+        kick(particles, forces, delta_t);
+        drift(particles, delta_t);
+        compute_forces(particles, forces);
     }
 
-private:
-    // Forze applicate a ogni particella (ipotizziamo che siano calcolate prima)
-    std::vector<FP> forces;
+    std::string name() const override { return "euler"; }
+
+    size_t force_evaluations() const override { return 1; }
 };
 
 #endif // EULER_EXPLICIT_INTEGRATOR_HPP
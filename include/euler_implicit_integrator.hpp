@@ -5,46 +5,44 @@
 #include <cmath>
 #include <vector>
 
-// Metodo di Eulero implicito
-template<std::floating_point FP>
-class EulerImplicitIntegrator : public Integrator<FP> {
+// Metodo di Eulero implicito: v' = v + dt F(x') / m, x' = x + dt v'.
+// Il sistema non lineare è risolto con iterazioni di punto fisso, ciascuna con una valutazione delle forze nella
+// stima corrente di x' (lo jacobiano delle forze, necessario a Newton-Raphson, non è disponibile).
+// Le iterazioni convergono se dt^2 |dF/dx| / m < 1.
+template<std::floating_point FP, size_t Dim>
+class EulerImplicitIntegrator : public Integrator<FP, Dim> {
 public:
-    // Implementazione del metodo di integrazione
-    void integrate(std::vector<Particle<FP>>& particles,
-                   const std::vector<std::vector<FP>>& forces,
-                   FP delta_t) override {
-        for (size_t i = 0; i < particles.size(); ++i) { // Itera su ogni particella
-            for (size_t dim = 0; dim < particles[i].pos.size(); ++dim) { // Itera su ogni dimensione
-                // Stima iniziale per posizione e velocità
-                FP new_pos = particles[i].pos[dim];
-                FP new_vel = particles[i].vel[dim];
-
-                // Iterazioni di Newton-Raphson per correzione implicita
-                for (size_t iter = 0; iter < max_iterations; ++iter) {
-                    // Accelerazione calcolata dalle forze pre-computate
-                    FP acceleration = forces[i][dim] / particles[i].mass;
-
-                    // Aggiorna velocità e posizione
-                    new_vel = particles[i].vel[dim] + delta_t * acceleration;
-                    new_pos = particles[i].pos[dim] + delta_t * new_vel;
-
-                    // Controllo di convergenza
-                    if (std::abs(new_pos - particles[i].pos[dim]) < tolerance &&
-                        std::abs(new_vel - particles[i].vel[dim]) < tolerance) {
-                        break; // Se la convergenza è soddisfatta, esci dall'iterazione
-                    }
-                }
-
-                // Aggiorna i valori finali di posizione e velocità
-                particles[i].pos[dim] = new_pos;
-                particles[i].vel[dim] = new_vel;
-            }
+    void integrate(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                   const typename Integrator<FP, Dim>::ForceCallback &compute_forces, FP delta_t) override {
+        start_pos = particles.pos();
+        start_vel = particles.vel();
+        for (size_t iter = 0; iter < max_iterations; ++iter) {
+            FP displacement = 0.0;
+            const FP change = this->max_reduction(update(particles, forces, delta_t, displacement));
+            displacement = this->max_reduction(displacement);
+            compute_forces(particles, forces);
+
+            // Convergenza: la correzione è piccola rispetto allo spostamento dello step
+            if (iter > 0 && change <= tolerance * displacement) break;
         }
     }
 
+    std::string name() const override { return "euler-implicit"; }
+
+    size_t force_evaluations() const override { return max_iterations; }
+
 private:
-    static constexpr size_t max_iterations = 10; // Numero massimo di iterazioni Newton-Raphson
-    static constexpr FP tolerance = 1e-5;        // Tolleranza per la convergenza
+    static constexpr size_t max_iterations = 10; // Numero massimo di iterazioni di punto fisso
+    static constexpr FP tolerance = 1e-10;       // Tolleranza relativa per la convergenza
+
+    VectorField<FP, Dim> start_pos; // Stato all'inizio dello step
+    VectorField<FP, Dim> start_vel;
+
+    // Nuova stima di x' e v' con le forze correnti (definita nel sorgente del modello scelto).
+    // Restituisce la norma massima della correzione delle posizioni e, in displacement,
+    // quella dello spostamento dall'inizio dello step.
+    FP update(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces, FP delta_t,
+              FP &displacement);
 };
 
 #endif // EULER_IMPLICIT_INTEGRATOR_HPP
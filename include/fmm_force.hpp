@@ -0,0 +1,320 @@
+#ifndef TEAM_05_NBODY_FMM_FORCE_HPP
+#define TEAM_05_NBODY_FMM_FORCE_HPP
+
+#include "force_evaluator.hpp"
+#include "direct_force.hpp"
+#include "multi_index.hpp"
+#include "orthant_tree.hpp"
+#include "profiler.hpp"
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+
+// Fast Multipole Method O(N) per il potenziale 1/r, in 2D e 3D.
+// Il potenziale 1/r non è armonico nel piano, quindi non si usano le espansioni complesse del caso logaritmico
+// ma espansioni cartesiane di Taylor fino all'ordine p (multipoli M_alpha, espansioni locali L_beta).
+// Le interazioni tra celle sono scelte con un attraversamento duale dell'albero: due celle sono ben separate se
+// (r_A + r_B) < theta |com_A - com_B|, e l'errore decresce come theta^(p+1).
+// L'attraversamento è definito nel sorgente del modello scelto (src/serial, src/openmp).
+// La legge di interazione con softening (interaction.hpp) è applicata solo alle interazioni dirette tra foglie
+// vicine: le espansioni restano quelle di 1/r, esatte per la spline (newtoniana oltre h = 2.8 epsilon) se le celle
+// ben separate distano più di h, e con un errore relativo O(epsilon^2 / r^2) per il nucleo di Plummer.
+template<std::floating_point FP, size_t Dim>
+class FmmForce : public ForceEvaluator<FP, Dim> {
+public:
+    FmmForce(FP G, int order = 4, size_t leaf_size = 64, FP theta = 0.6, const Interaction &interaction = {})
+            : G(G), theta(theta), leaf_size(leaf_size), interaction(interaction), table(order) {
+        if (order < 1 || order > 30) throw std::invalid_argument("The FMM expansion order must be in [1, 30]");
+        if (theta <= 0 || theta >= 1) throw std::invalid_argument("The FMM separation theta must be in (0, 1)");
+        if (leaf_size == 0) throw std::invalid_argument("The leaf size must be positive");
+    }
+
+    void compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) override;
+
+    std::string name() const override {
+        std::ostringstream stream;
+        stream << "fmm (order = " << table.order() << ", leaf size = " << leaf_size << ", theta = " << theta;
+        if (interaction.softening != Softening::NONE) stream << ", " << interaction.name();
+        stream << ")";
+        return stream.str();
+    }
+
+private:
+    using Tree = OrthantTree<FP, Dim>;
+    using Node = typename Tree::Node;
+
+    FP G;
+    FP theta;
+    size_t leaf_size;
+    Interaction interaction;
+    MultiIndexTable<Dim> table;
+    Tree tree;
+
+    // Posizioni, masse e forze nell'ordine dell'albero: le particelle di ogni cella sono contigue
+    VectorField<FP, Dim> sorted_pos;
+    aligned_vector<FP> sorted_mass;
+    VectorField<FP, Dim> sorted_force;
+    aligned_vector<FP> sorted_potential; // phi(x_i) = sum_j m_j / |x_i - x_j|, senza il fattore G
+
+    std::vector<FP> multipoles; // [nodo][coefficiente]: M_alpha = sum_j m_j (x_j - com)^alpha / alpha!
+    std::vector<FP> locals;     // [nodo][coefficiente]: phi(x) = sum_beta L_beta (x - com)^beta
+
+    // Il criterio di separazione tra due celle distinte
+    bool well_separated(const Node &a, const Node &b) const {
+        FP dist_squared = 0.0;
+        for (size_t d = 0; d < Dim; ++d) dist_squared += (a.com[d] - b.com[d]) * (a.com[d] - b.com[d]);
+        const FP radii = a.radius + b.radius;
+        return radii * radii < theta * theta * dist_squared;
+    }
+
+    // Interazione della cella sorgente con la cella bersaglio (definito nel sorgente del modello)
+    void traverse(uint32_t source, uint32_t target);
+
+    // r^alpha per tutti i multi-indici; con la divisione per alpha! se scaled è vero
+    void monomials(const Vec<FP, Dim> &r, FP *out, bool scaled) const;
+
+    // Copia delle particelle nell'ordine dell'albero e, alla fine, delle forze nell'ordine originale
+    // (con l'energia potenziale -G/2 sum_i m_i phi(x_i))
+    void gather(const ParticleSystem<FP, Dim> &particles);
+
+    void scatter(VectorField<FP, Dim> &forces);
+
+    void upward_pass();
+
+    void downward_pass();
+
+    void m2l(uint32_t source, uint32_t target);
+
+    // Sceglie la legge di interazione una volta per coppia di foglie
+    void p2p(uint32_t source, uint32_t target) {
+        with_interaction_law<FP>(interaction, [&](const auto &law) { p2p(law, source, target); });
+    }
+
+    template<typename Law>
+    void p2p(const Law &law, uint32_t source, uint32_t target);
+};
+
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::monomials(const Vec<FP, Dim> &r, FP *out, bool scaled) const {
+    const int p = table.order();
+    std::array<std::array<FP, 64>, Dim> powers;
+    for (size_t d = 0; d < Dim; ++d) {
+        powers[d][0] = 1.0;
+        for (int k = 1; k <= p; ++k) powers[d][k] = powers[d][k - 1] * r[d];
+    }
+    for (size_t k = 0; k < table.size(); ++k) {
+        FP value = scaled ? FP(table.inv_factorial(k)) : FP(1.0);
+        for (size_t d = 0; d < Dim; ++d) value *= powers[d][table[k][d]];
+        out[k] = value;
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::gather(const ParticleSystem<FP, Dim> &particles) {
+    const auto &order = tree.order();
+    const size_t n = particles.size();
+    sorted_pos.resize(n);
+    sorted_mass.resize(n);
+    sorted_force.resize(n);
+    sorted_potential.assign(n, 0.0);
+    for (size_t k = 0; k < n; ++k) {
+        for (size_t d = 0; d < Dim; ++d) {
+            sorted_pos[d][k] = particles.pos()[d][order[k]];
+            sorted_force[d][k] = 0.0;
+        }
+        sorted_mass[k] = particles.mass()[order[k]];
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::scatter(VectorField<FP, Dim> &forces) {
+    const auto &order = tree.order();
+    FP mass_potential = 0.0;
+    for (size_t k = 0; k < order.size(); ++k) {
+        for (size_t d = 0; d < Dim; ++d) forces[d][order[k]] = G * sorted_mass[k] * sorted_force[d][k];
+        mass_potential += sorted_mass[k] * sorted_potential[k];
+    }
+    this->potential = -G * mass_potential / 2;
+}
+
+// P2M nelle foglie e M2M verso i padri, visitando l'arena all'indietro (figli prima dei padri)
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::upward_pass() {
+    const auto &nodes = tree.nodes();
+    const size_t size = table.size();
+    std::vector<FP> mono(size);
+
+    multipoles.assign(nodes.size() * size, 0.0);
+    for (size_t index = nodes.size(); index-- > 0;) {
+        const Node &node = nodes[index];
+        FP *multipole = multipoles.data() + index * size;
+
+        if (node.is_leaf()) {
+            for (uint32_t j = node.begin; j < node.end; ++j) {
+                Vec<FP, Dim> r;
+                for (size_t d = 0; d < Dim; ++d) r[d] = sorted_pos[d][j] - node.com[d];
+                monomials(r, mono.data(), true);
+                for (size_t a = 0; a < size; ++a) multipole[a] += sorted_mass[j] * mono[a];
+            }
+        } else {
+            for (uint32_t c = node.first_child; c < node.first_child + node.child_count; ++c) {
+                Vec<FP, Dim> r;
+                for (size_t d = 0; d < Dim; ++d) r[d] = nodes[c].com[d] - node.com[d];
+                monomials(r, mono.data(), true);
+                const FP *child = multipoles.data() + c * size;
+                for (const auto &pair: table.shift_pairs())
+                    multipole[pair.alpha] += child[pair.beta] * mono[pair.combined];
+            }
+        }
+    }
+}
+
+// M2L: espansione locale nel bersaglio generata dai multipoli della sorgente
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::m2l(uint32_t source, uint32_t target) {
+    const auto &nodes = tree.nodes();
+    const size_t size = table.size();
+    const int p = table.order();
+
+    Vec<FP, Dim> r;
+    FP dist_squared = 0.0;
+    for (size_t d = 0; d < Dim; ++d) {
+        r[d] = nodes[target].com[d] - nodes[source].com[d];
+        dist_squared += r[d] * r[d];
+    }
+
+    // Derivate D^gamma (1/|r|) per |gamma| <= p
+    thread_local std::vector<FP> mono, derivative;
+    mono.resize(size);
+    derivative.resize(size);
+    monomials(r, mono.data(), false);
+
+    std::array<FP, 64> inv_dist_powers; // 1 / |r|^(2n+1)
+    const FP inv_dist_squared = 1 / dist_squared;
+    inv_dist_powers[0] = std::sqrt(inv_dist_squared);
+    for (int n = 1; n <= p; ++n) inv_dist_powers[n] = inv_dist_powers[n - 1] * inv_dist_squared;
+
+    for (size_t g = 0; g < size; ++g) {
+        FP value = 0.0;
+        for (const auto &term: table.derivative_terms(g))
+            value += FP(term.coefficient) * mono[term.exponent] * inv_dist_powers[term.n];
+        derivative[g] = value;
+    }
+
+    const FP *multipole = multipoles.data() + source * size;
+    FP *local = locals.data() + target * size;
+    for (const auto &pair: table.translation_pairs())
+        local[pair.beta] += FP(pair.sign * table.inv_factorial(pair.beta)) * multipole[pair.alpha] *
+                            derivative[pair.combined];
+}
+
+// P2P: interazioni dirette delle particelle della foglia sorgente su quelle della foglia bersaglio
+// (le forze sono accumulate senza il fattore G m_i, applicato in scatter)
+template<std::floating_point FP, size_t Dim>
+template<typename Law>
+void FmmForce<FP, Dim>::p2p(const Law &law, uint32_t source, uint32_t target) {
+    const auto &nodes = tree.nodes();
+    const uint32_t source_begin = nodes[source].begin, source_end = nodes[source].end;
+
+    for (uint32_t i = nodes[target].begin; i < nodes[target].end; ++i) {
+        Vec<FP, Dim> pos_i, force_i{};
+        FP potential_i = 0.0;
+        for (size_t d = 0; d < Dim; ++d) pos_i[d] = sorted_pos[d][i];
+        for (uint32_t j = source_begin; j < source_end; ++j) {
+            Vec<FP, Dim> diff;
+            FP dist_squared = 0.0;
+            for (size_t d = 0; d < Dim; ++d) {
+                diff[d] = sorted_pos[d][j] - pos_i[d];
+                dist_squared += diff[d] * diff[d];
+            }
+            // Le coppie coincidenti (anche i == j) non contribuiscono
+            if (dist_squared == 0) continue;
+            FP factor, pair_potential;
+            law(sorted_mass[j], dist_squared, factor, pair_potential);
+            potential_i += pair_potential;
+            for (size_t d = 0; d < Dim; ++d) force_i[d] += factor * diff[d];
+        }
+        for (size_t d = 0; d < Dim; ++d) sorted_force[d][i] += force_i[d];
+        sorted_potential[i] += potential_i;
+    }
+}
+
+// L2L verso i figli, visitando l'arena in avanti (padri prima dei figli), e L2P nelle foglie
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::downward_pass() {
+    const auto &nodes = tree.nodes();
+    const size_t size = table.size();
+    std::vector<FP> mono(size);
+
+    for (size_t index = 0; index < nodes.size(); ++index) {
+        const Node &node = nodes[index];
+        const FP *local = locals.data() + index * size;
+
+        if (!node.is_leaf()) {
+            for (uint32_t c = node.first_child; c < node.first_child + node.child_count; ++c) {
+                Vec<FP, Dim> r;
+                for (size_t d = 0; d < Dim; ++d) r[d] = nodes[c].com[d] - node.com[d];
+                monomials(r, mono.data(), true);
+                FP *child = locals.data() + c * size;
+                for (const auto &pair: table.shift_pairs())
+                    child[pair.beta] += FP(table.inv_factorial(pair.beta) / table.inv_factorial(pair.alpha)) *
+                                        local[pair.alpha] * mono[pair.combined];
+            }
+            continue;
+        }
+
+        // Gradiente dell'espansione locale: d phi / d x_d = sum_beta L_beta beta_d (x - com)^(beta - e_d)
+        for (uint32_t i = node.begin; i < node.end; ++i) {
+            Vec<FP, Dim> r;
+            for (size_t d = 0; d < Dim; ++d) r[d] = sorted_pos[d][i] - node.com[d];
+            monomials(r, mono.data(), false);
+
+            FP potential_i = 0.0;
+            for (size_t b = 0; b < size; ++b) potential_i += local[b] * mono[b];
+            sorted_potential[i] += potential_i;
+
+            for (size_t d = 0; d < Dim; ++d) {
+                FP gradient = 0.0;
+                for (size_t b = 0; b < size; ++b) {
+                    const int beta_d = table[b][d];
+                    if (beta_d == 0) continue;
+                    auto lowered = table[b];
+                    --lowered[d];
+                    gradient += local[b] * FP(beta_d) * mono[table.lookup(lowered)];
+                }
+                sorted_force[d][i] += gradient;
+            }
+        }
+    }
+}
+
+// Confronto dell'accuratezza del FMM al variare dell'ordine, rispetto alla somma diretta
+template<std::floating_point FP, size_t Dim>
+void fmm_accuracy_report(const ParticleSystem<FP, Dim> &particles, FP G, int max_order, size_t leaf_size, FP theta,
+                         const Interaction &interaction, std::ostream &stream) {
+    using clock = std::chrono::steady_clock;
+    VectorField<FP, Dim> reference(particles.size()), forces(particles.size());
+
+    auto start = clock::now();
+    DirectForce<FP, Dim>(G, PairKernel<FP, Dim>(detect_simd_isa(), KernelPrecision::FULL, interaction))
+            .compute_forces(particles, reference);
+    const double direct_time = std::chrono::duration<double>(clock::now() - start).count();
+
+    stream << "FMM accuracy report (N = " << particles.size() << ", leaf size = " << leaf_size << ", theta = "
+           << theta << ", direct sum: " << direct_time << " s)\n";
+    stream << std::setw(6) << "order" << std::setw(14) << "mean rel err" << std::setw(14) << "max rel err"
+           << std::setw(14) << "global err" << std::setw(12) << "time [s]" << "\n";
+    for (int order = 1; order <= max_order; ++order) {
+        FmmForce<FP, Dim> fmm(G, order, leaf_size, theta, interaction);
+        start = clock::now();
+        fmm.compute_forces(particles, forces);
+        const double time = std::chrono::duration<double>(clock::now() - start).count();
+
+        const ForceError error = compare_forces(reference, forces);
+        stream << std::setw(6) << order << std::setw(14) << error.mean_relative << std::setw(14)
+               << error.max_relative << std::setw(14) << error.global << std::setw(12) << time << "\n";
+    }
+}
+
+#endif // TEAM_05_NBODY_FMM_FORCE_HPP
@@ -0,0 +1,72 @@
+#ifndef TEAM_05_NBODY_FORCE_EVALUATOR_HPP
+#define TEAM_05_NBODY_FORCE_EVALUATOR_HPP
+
+#include "particle_system.hpp"
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Interfaccia astratta per il calcolo delle forze gravitazionali (somma diretta, Barnes-Hut, ...)
+template<std::floating_point FP, size_t Dim>
+class ForceEvaluator {
+public:
+    virtual ~ForceEvaluator() = default;
+
+    // Calcola (sovrascrivendo) la forza agente su ogni particella
+    virtual void compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) = 0;
+
+    // Calcola (sovrascrivendo) la forza sulle sole particelle indicate, dovuta a tutte le particelle.
+    // Le altre componenti di forces non sono significative all'uscita; l'implementazione di base le calcola tutte.
+    virtual void compute_active_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                                       const std::vector<uint32_t> &active) {
+        (void) active;
+        compute_forces(particles, forces);
+    }
+
+    // Energia potenziale totale nelle posizioni dell'ultimo calcolo, accumulata insieme alle forze.
+    // Non è disponibile se l'ultimo calcolo ha riguardato solo una parte delle particelle.
+    std::optional<FP> potential_energy() const { return potential; }
+
+    // Descrizione del metodo, per i log
+    virtual std::string name() const = 0;
+
+protected:
+    std::optional<FP> potential;
+};
+
+// Errore di un campo di forze rispetto a uno di riferimento
+struct ForceError {
+    double mean_relative; // Media su tutte le particelle di |F - F_ref| / |F_ref|
+    double max_relative;  // Massimo su tutte le particelle di |F - F_ref| / |F_ref|
+    double global;        // sqrt(sum |F - F_ref|^2 / sum |F_ref|^2)
+};
+
+template<std::floating_point FP, std::floating_point FP_ref, size_t Dim>
+ForceError compare_forces(const VectorField<FP_ref, Dim> &reference, const VectorField<FP, Dim> &forces) {
+    ForceError error{0.0, 0.0, 0.0};
+    double error_norm = 0.0, reference_norm = 0.0;
+    size_t counted = 0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        double diff_squared = 0.0, ref_squared = 0.0;
+        for (size_t d = 0; d < Dim; ++d) {
+            const double diff = double(forces[d][i]) - double(reference[d][i]);
+            diff_squared += diff * diff;
+            ref_squared += double(reference[d][i]) * double(reference[d][i]);
+        }
+        error_norm += diff_squared;
+        reference_norm += ref_squared;
+        if (ref_squared > 0) {
+            const double relative = std::sqrt(diff_squared / ref_squared);
+            error.mean_relative += relative;
+            error.max_relative = std::max(error.max_relative, relative);
+            ++counted;
+        }
+    }
+    if (counted > 0) error.mean_relative /= counted;
+    if (reference_norm > 0) error.global = std::sqrt(error_norm / reference_norm);
+    return error;
+}
+
+#endif // TEAM_05_NBODY_FORCE_EVALUATOR_HPP
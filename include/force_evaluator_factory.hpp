@@ -0,0 +1,38 @@
+#ifndef TEAM_05_NBODY_FORCE_EVALUATOR_FACTORY_HPP
+#define TEAM_05_NBODY_FORCE_EVALUATOR_FACTORY_HPP
+
+#include "direct_force.hpp"
+#include "barnes_hut_force.hpp"
+#include "fmm_force.hpp"
+#include "json.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Crea il metodo di calcolo delle forze dalle chiavi del file di input: "force_engine" ("direct" (default),
+// "barnes-hut" o "fmm") e i parametri del metodo scelto
+template<std::floating_point FP, size_t Dim>
+std::unique_ptr<ForceEvaluator<FP, Dim>> make_force_evaluator(const nlohmann::json &data, FP G,
+                                                              const Interaction &interaction) {
+    const std::string force_engine = data.value("force_engine", "direct");
+    if (force_engine == "direct") {
+        // Precisione ridotta (rsqrt approssimata) o mista (coppie in float) del kernel, opzionali
+        const bool reduced = data.value("reduced_precision", false), mixed = data.value("mixed_precision", false);
+        if (reduced && mixed) throw std::invalid_argument("reduced_precision and mixed_precision are exclusive");
+        const KernelPrecision precision = reduced ? KernelPrecision::REDUCED
+                                                  : mixed ? KernelPrecision::MIXED : KernelPrecision::FULL;
+        return std::make_unique<DirectForce<FP, Dim>>(G, PairKernel<FP, Dim>(detect_simd_isa(), precision,
+                                                                             interaction));
+    }
+    if (force_engine == "barnes-hut") {
+        return std::make_unique<BarnesHutForce<FP, Dim>>(G, data.value("theta", FP(0.5)),
+                                                         data.value("leaf_size", size_t(8)), interaction);
+    }
+    if (force_engine == "fmm") {
+        return std::make_unique<FmmForce<FP, Dim>>(G, data.value("fmm_order", 4), data.value("leaf_size", size_t(64)),
+                                                   data.value("theta", FP(0.6)), interaction);
+    }
+    throw std::invalid_argument("Unknown force engine: " + force_engine);
+}
+
+#endif // TEAM_05_NBODY_FORCE_EVALUATOR_FACTORY_HPP
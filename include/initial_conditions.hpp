@@ -0,0 +1,157 @@
+#ifndef TEAM_05_NBODY_INITIAL_CONDITIONS_HPP
+#define TEAM_05_NBODY_INITIAL_CONDITIONS_HPP
+
+#include "particle_system.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Condizioni iniziali sintetiche, per benchmark e prove senza file di input.
+// Unità: massa totale 1 / G (quindi G M = 1) e lunghezza di scala 1; centro di massa fermo nell'origine.
+enum class InitialConditions {
+    PLUMMER,      // Sfera di Plummer in equilibrio (proiettata sui primi Dim assi se Dim < 3)
+    UNIFORM_CUBE, // Cubo di lato 1 a densità uniforme, velocità nulle (collasso freddo)
+    DISK          // Corpo centrale con metà della massa e disco sottile in rotazione circolare (Dim >= 2)
+};
+
+inline InitialConditions parse_initial_conditions(const std::string &name) {
+    if (name == "plummer") return InitialConditions::PLUMMER;
+    if (name == "uniform-cube") return InitialConditions::UNIFORM_CUBE;
+    if (name == "disk") return InitialConditions::DISK;
+    throw std::invalid_argument("Unknown initial conditions: " + name);
+}
+
+inline std::string to_string(InitialConditions kind) {
+    switch (kind) {
+        case InitialConditions::PLUMMER: return "plummer";
+        case InitialConditions::UNIFORM_CUBE: return "uniform-cube";
+        default: return "disk";
+    }
+}
+
+namespace initial_conditions_detail {
+
+// Direzione uniforme sulla sfera unitaria in 3D
+template<std::floating_point FP, typename Engine>
+std::array<FP, 3> random_direction(Engine &engine) {
+    std::uniform_real_distribution<FP> uniform(-1.0, 1.0);
+    const FP z = uniform(engine);
+    const FP phi = std::numbers::pi_v<FP> * uniform(engine);
+    const FP s = std::sqrt(1 - z * z);
+    return {s * std::cos(phi), s * std::sin(phi), z};
+}
+
+// Porta il centro di massa nell'origine e ne annulla la velocità
+template<std::floating_point FP, size_t Dim>
+void center(ParticleSystem<FP, Dim> &particles) {
+    FP total_mass = 0.0;
+    for (size_t i = 0; i < particles.size(); ++i) total_mass += particles.mass()[i];
+    for (size_t d = 0; d < Dim; ++d) {
+        FP *pos = particles.pos()[d];
+        FP *vel = particles.vel()[d];
+        FP mean_pos = 0.0, mean_vel = 0.0;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            mean_pos += particles.mass()[i] * pos[i];
+            mean_vel += particles.mass()[i] * vel[i];
+        }
+        mean_pos /= total_mass;
+        mean_vel /= total_mass;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            pos[i] -= mean_pos;
+            vel[i] -= mean_vel;
+        }
+    }
+}
+
+} // namespace initial_conditions_detail
+
+// Genera n particelle con il generatore pseudo-casuale inizializzato da seed (risultato riproducibile)
+template<std::floating_point FP, size_t Dim>
+ParticleSystem<FP, Dim> make_initial_conditions(InitialConditions kind, size_t n, FP G, uint64_t seed = 42) {
+    using namespace initial_conditions_detail;
+    if (n == 0) throw std::invalid_argument("The number of particles must be positive");
+    if (kind == InitialConditions::DISK && Dim < 2) throw std::invalid_argument("A disk needs at least 2 dimensions");
+
+    std::mt19937_64 engine(seed);
+    std::uniform_real_distribution<FP> uniform(0.0, 1.0);
+    const FP total_mass = 1 / G;
+
+    ParticleSystem<FP, Dim> particles;
+    particles.reserve(n);
+    std::vector<FP> position(Dim), velocity(Dim);
+
+    switch (kind) {
+        case InitialConditions::PLUMMER:
+            // Aarseth, Hénon e Wielen (1974): raggio dalla massa cumulativa, velocità per rigetto da
+            // g(q) = q^2 (1 - q^2)^(7/2), con q = v / v_fuga. Le particelle oltre 10 raggi di scala sono riestratte.
+            for (size_t i = 0; i < n; ++i) {
+                FP radius;
+                do {
+                    radius = 1 / std::sqrt(std::pow(uniform(engine), FP(-2.0 / 3.0)) - 1);
+                } while (!(radius < 10));
+
+                FP q, g;
+                do {
+                    q = uniform(engine);
+                    g = FP(0.1) * uniform(engine);
+                } while (g > q * q * std::pow(1 - q * q, FP(3.5)));
+                const FP speed = q * std::sqrt(FP(2.0)) * std::pow(1 + radius * radius, FP(-0.25));
+
+                const auto r_direction = random_direction<FP>(engine), v_direction = random_direction<FP>(engine);
+                for (size_t d = 0; d < Dim; ++d) {
+                    position[d] = radius * r_direction[d % 3];
+                    velocity[d] = speed * v_direction[d % 3];
+                }
+                particles.push_back(Particle<FP>(total_mass / FP(n), position, velocity));
+            }
+            break;
+
+        case InitialConditions::UNIFORM_CUBE:
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t d = 0; d < Dim; ++d) {
+                    position[d] = uniform(engine) - FP(0.5);
+                    velocity[d] = 0.0;
+                }
+                particles.push_back(Particle<FP>(total_mass / FP(n), position, velocity));
+            }
+            break;
+
+        case InitialConditions::DISK: {
+            // Il corpo centrale ha metà della massa; il disco ha densità superficiale uniforme tra r = 0.1 e r = 1,
+            // con velocità circolari dovute alla massa interna (approssimata come sferica)
+            std::fill(position.begin(), position.end(), FP(0.0));
+            std::fill(velocity.begin(), velocity.end(), FP(0.0));
+            particles.push_back(Particle<FP>(n > 1 ? total_mass / 2 : total_mass, position, velocity));
+
+            const FP inner = 0.1, outer = 1.0;
+            const FP disk_mass = total_mass / 2;
+            std::normal_distribution<FP> thickness(0.0, 0.01);
+            for (size_t i = 1; i < n; ++i) {
+                const FP radius = std::sqrt(inner * inner + (outer * outer - inner * inner) * uniform(engine));
+                const FP angle = 2 * std::numbers::pi_v<FP> * uniform(engine);
+                const FP enclosed = total_mass / 2 +
+                                    disk_mass * (radius * radius - inner * inner) / (outer * outer - inner * inner);
+                const FP speed = std::sqrt(G * enclosed / radius);
+
+                position[0] = radius * std::cos(angle);
+                position[1] = radius * std::sin(angle);
+                velocity[0] = -speed * std::sin(angle);
+                velocity[1] = speed * std::cos(angle);
+                for (size_t d = 2; d < Dim; ++d) position[d] = thickness(engine);
+                particles.push_back(Particle<FP>(disk_mass / FP(n - 1), position, velocity));
+            }
+            break;
+        }
+    }
+
+    center(particles);
+    return particles;
+}
+
+#endif // TEAM_05_NBODY_INITIAL_CONDITIONS_HPP
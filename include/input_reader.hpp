@@ -0,0 +1,515 @@
+#ifndef TEAM_05_NBODY_INPUT_READER_HPP
+#define TEAM_05_NBODY_INPUT_READER_HPP
+
+#include "particle_system.hpp"
+#include "trajectory.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Lettura del file di input senza costruire il documento JSON completo: la configurazione (tutte le chiavi
+// tranne "particles") diventa un piccolo oggetto JSON, mentre le particelle sono analizzate in streaming (SAX) e
+// copiate direttamente nel layout SoA. In alternativa all'array "particles", la chiave "particles_file" indica
+// un file binario nel formato della traiettoria (vedi trajectory.hpp), letto con una mappatura in memoria: si
+// usa il frame "particles_frame" (default 0). Il percorso è relativo alla cartella del file di input.
+
+// Intervallo [begin, end) delle particelle da conservare, in funzione del numero totale di particelle
+using ParticleSelection = std::function<std::pair<size_t, size_t>(size_t)>;
+
+inline std::pair<size_t, size_t> select_all_particles(size_t n) { return {0, n}; }
+
+namespace input_reader_detail {
+
+using json = nlohmann::json;
+
+[[noreturn]] inline void fail(const std::string &file_name, const std::string &message) {
+    throw std::runtime_error("Error: " + file_name + ": " + message);
+}
+
+// Costruisce il documento delle chiavi di configurazione, un valore alla volta
+class ConfigBuilder {
+public:
+    explicit ConfigBuilder(json &root) : root(root) {}
+
+    void start(json &&value) {
+        json &inserted = insert(std::move(value));
+        stack.push_back(&inserted);
+    }
+
+    void end() { stack.pop_back(); }
+
+    void value(json &&value) { insert(std::move(value)); }
+
+    void key(const std::string &name) { pending_key = name; }
+
+private:
+    json &root;
+    std::vector<json *> stack;
+    std::string pending_key;
+
+    json &insert(json &&value) {
+        if (stack.empty()) return root[pending_key] = std::move(value);
+        json &parent = *stack.back();
+        if (parent.is_array()) {
+            parent.push_back(std::move(value));
+            return parent.back();
+        }
+        return parent[pending_key] = std::move(value);
+    }
+};
+
+// Gestore SAX del file di input: config riceve le chiavi di primo livello, le particelle nell'intervallo
+// selezionato sono aggiunte a particles
+template<std::floating_point FP, size_t Dim>
+class InputHandler : public nlohmann::json_sax<json> {
+public:
+    InputHandler(const std::string &file_name, json &config, ParticleSystem<FP, Dim> &particles,
+                 const ParticleSelection &select)
+            : file_name(file_name), config(config), builder(config), particles(particles), select(select) {}
+
+    size_t count() const { return particle_count; }
+
+    // Se N non precede le particelle si conservano tutte, e la selezione è applicata alla fine
+    bool selected_all() const { return keep_end == std::numeric_limits<size_t>::max() && keep_begin == 0; }
+
+    bool null() override { return scalar(nullptr); }
+
+    bool boolean(bool value) override { return scalar(value); }
+
+    bool number_integer(number_integer_t value) override { return number(FP(value), value); }
+
+    bool number_unsigned(number_unsigned_t value) override { return number(FP(value), value); }
+
+    bool number_float(number_float_t value, const string_t &) override { return number(FP(value), value); }
+
+    bool string(string_t &value) override { return scalar(value); }
+
+    bool binary(binary_t &) override { fail(file_name, "binary values are not supported"); }
+
+    bool start_object(std::size_t) override {
+        ++depth;
+        if (depth == 1) return true;
+        if (state == State::PARTICLES_KEY) fail(file_name, "particles must be an array");
+        if (state == State::PARTICLES && depth == 3) {
+            state = State::PARTICLE;
+            mass_set = false;
+            position_count = velocity_count = 0;
+            return true;
+        }
+        if (in_particles()) return skip_or_fail("an object");
+        builder.start(json::object());
+        return true;
+    }
+
+    bool key(string_t &name) override {
+        if (depth == 1) {
+            if (name == "particles") state = State::PARTICLES_KEY;
+            else builder.key(name);
+        } else if (state == State::PARTICLE) {
+            field = name == "mass" ? Field::MASS : name == "position" ? Field::POSITION
+                  : name == "velocity" ? Field::VELOCITY : Field::OTHER;
+        } else if (!in_particles()) {
+            builder.key(name);
+        }
+        return true;
+    }
+
+    bool end_object() override {
+        if (state == State::PARTICLE && depth == 3) {
+            if (!mass_set || position_count != Dim || velocity_count != Dim) {
+                fail(file_name, "particle " + std::to_string(particle_count) + " needs a mass, a position and a "
+                                "velocity with " + std::to_string(Dim) + " components");
+            }
+            if (particle_count >= keep_begin && particle_count < keep_end) {
+                particles.push_back(mass, position, velocity);
+            }
+            ++particle_count;
+            state = State::PARTICLES;
+        } else if (skip_depth > 0 && depth == skip_depth) {
+            skip_depth = 0;
+        } else if (depth > 1 && !in_particles()) {
+            builder.end();
+        }
+        --depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth;
+        if (state == State::PARTICLES_KEY && depth == 2) {
+            state = State::PARTICLES;
+            start_particles();
+            return true;
+        }
+        if (state == State::PARTICLE && depth == 4 && (field == Field::POSITION || field == Field::VELOCITY)) {
+            state = State::COMPONENTS;
+            return true;
+        }
+        if (in_particles()) return skip_or_fail("an array");
+        builder.start(json::array());
+        return true;
+    }
+
+    bool end_array() override {
+        if (state == State::COMPONENTS && depth == 4) {
+            state = State::PARTICLE;
+        } else if (state == State::PARTICLES && depth == 2) {
+            state = State::TOP;
+        } else if (skip_depth > 0 && depth == skip_depth) {
+            skip_depth = 0;
+        } else if (!in_particles()) {
+            builder.end();
+        }
+        --depth;
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &error) override {
+        fail(file_name, "invalid JSON at byte " + std::to_string(position) + " (" + error.what() + ")");
+    }
+
+private:
+    enum class State { TOP, PARTICLES_KEY, PARTICLES, PARTICLE, COMPONENTS };
+    enum class Field { MASS, POSITION, VELOCITY, OTHER };
+
+    const std::string &file_name;
+    json &config;
+    ConfigBuilder builder;
+    ParticleSystem<FP, Dim> &particles;
+    const ParticleSelection &select;
+
+    State state = State::TOP;
+    Field field = Field::OTHER;
+    size_t depth = 0;
+    size_t skip_depth = 0; // Profondità del valore ignorato in corso (campi sconosciuti delle particelle)
+    size_t particle_count = 0;
+    size_t keep_begin = 0, keep_end = std::numeric_limits<size_t>::max();
+
+    FP mass = 0.0;
+    bool mass_set = false;
+    Vec<FP, Dim> position{}, velocity{};
+    size_t position_count = 0, velocity_count = 0;
+
+    bool in_particles() const { return state != State::TOP && state != State::PARTICLES_KEY; }
+
+    void start_particles() {
+        if (!config.contains("N")) return;
+        if (!config["N"].is_number_unsigned()) fail(file_name, "N must be a non-negative integer");
+        std::tie(keep_begin, keep_end) = select(config["N"].template get<size_t>());
+        particles.reserve(keep_end - keep_begin);
+    }
+
+    // Campi sconosciuti di una particella: ignorati, come i valori che contengono
+    bool skip_or_fail(const char *what) {
+        if (skip_depth > 0) return true;
+        if (state == State::PARTICLE && field == Field::OTHER) {
+            skip_depth = depth;
+            return true;
+        }
+        fail(file_name, "unexpected " + std::string(what) + " in particle " + std::to_string(particle_count));
+    }
+
+    template<typename Value>
+    bool scalar(Value &&value) {
+        if (state == State::PARTICLES_KEY) fail(file_name, "particles must be an array");
+        if (in_particles()) {
+            if (skip_depth > 0 || (state == State::PARTICLE && field == Field::OTHER)) return true;
+            fail(file_name, "unexpected value in particle " + std::to_string(particle_count));
+        }
+        builder.value(json(std::forward<Value>(value)));
+        return true;
+    }
+
+    template<typename Value>
+    bool number(FP value, Value original) {
+        if (!in_particles() || skip_depth > 0) return scalar(original);
+        if (state == State::PARTICLE && field == Field::MASS) {
+            mass = value;
+            mass_set = true;
+        } else if (state == State::COMPONENTS) {
+            size_t &count = field == Field::POSITION ? position_count : velocity_count;
+            if (count == Dim) {
+                fail(file_name, "particle " + std::to_string(particle_count) + " has more than " +
+                                std::to_string(Dim) + " components");
+            }
+            (field == Field::POSITION ? position : velocity)[count++] = value;
+        } else {
+            return scalar(original);
+        }
+        return true;
+    }
+};
+
+// Gestore SAX che conta le componenti della posizione della prima particella e si ferma alla fine di quella
+// posizione: delle chiavi "particles_file" e "precision" vede quindi solo quelle che precedono "particles".
+class DimensionProbe : public nlohmann::json_sax<json> {
+public:
+    size_t dimensions = 0;
+    bool found = false;
+    std::string particles_file;
+    std::string precision;
+
+    bool null() override { return true; }
+
+    bool boolean(bool) override { return true; }
+
+    bool number_integer(number_integer_t) override { return component(); }
+
+    bool number_unsigned(number_unsigned_t) override { return component(); }
+
+    bool number_float(number_float_t, const string_t &) override { return component(); }
+
+    bool string(string_t &value) override {
+        if (depth == 1 && last_key == "particles_file") particles_file = value;
+        if (depth == 1 && last_key == "precision") precision = value;
+        return true;
+    }
+
+    bool binary(binary_t &) override { return true; }
+
+    bool start_object(std::size_t) override {
+        ++depth;
+        if (depth == 3 && particles_key) ++object_count;
+        return true;
+    }
+
+    bool key(string_t &name) override {
+        if (depth == 1) particles_key = name == "particles";
+        last_key = name;
+        return true;
+    }
+
+    bool end_object() override {
+        --depth;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth;
+        in_position = particles_key && depth == 4 && object_count == 1 && last_key == "position";
+        return true;
+    }
+
+    bool end_array() override {
+        --depth;
+        if (in_position) {
+            found = true;
+            in_position = false;
+            return false; // Interrompe la lettura
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &error) override {
+        throw std::runtime_error("Error: invalid JSON at byte " + std::to_string(position) + " (" + error.what() + ")");
+    }
+
+private:
+    size_t depth = 0, object_count = 0;
+    bool particles_key = false, in_position = false;
+    std::string last_key;
+
+    bool component() {
+        if (in_position) ++dimensions;
+        return true;
+    }
+};
+
+// File mappato in memoria in sola lettura
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &file_name) {
+        const int descriptor = ::open(file_name.c_str(), O_RDONLY);
+        if (descriptor < 0) throw std::runtime_error("Error: Unable to open file " + file_name);
+        struct stat status{};
+        if (fstat(descriptor, &status) != 0) {
+            ::close(descriptor);
+            throw std::runtime_error("Error: Unable to read file " + file_name);
+        }
+        bytes = static_cast<size_t>(status.st_size);
+        if (bytes > 0) {
+            void *mapping = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(descriptor);
+                throw std::runtime_error("Error: Unable to map file " + file_name);
+            }
+            address = static_cast<const char *>(mapping);
+        }
+        ::close(descriptor);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        if (address) munmap(const_cast<char *>(address), bytes);
+    }
+
+    const char *data() const { return address; }
+
+    size_t size() const { return bytes; }
+
+private:
+    const char *address = nullptr;
+    size_t bytes = 0;
+};
+
+// Copia count valori di tipo Stored, convertiti in FP
+template<typename Stored, std::floating_point FP>
+void copy_values(const char *source, size_t count, FP *destination) {
+    if constexpr (std::is_same_v<Stored, FP>) {
+        std::memcpy(destination, source, count * sizeof(FP));
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            Stored value;
+            std::memcpy(&value, source + i * sizeof(Stored), sizeof(Stored));
+            destination[i] = static_cast<FP>(value);
+        }
+    }
+}
+
+} // namespace input_reader_detail
+
+// Header di un file binario di particelle (formato della traiettoria), con verifica del formato
+inline TrajectoryHeader read_particle_file_header(const std::string &file_name) {
+    TrajectoryHeader header{};
+    std::ifstream input(file_name, std::ios::binary);
+    if (!input.is_open()) throw std::runtime_error("Error: Unable to open file " + file_name);
+    if (!input.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "NBODYTRJ", sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Error: " + file_name + " is not a particle or trajectory file");
+    }
+    return header;
+}
+
+// Legge le particelle [begin, end) del frame indicato di un file binario di particelle
+template<std::floating_point FP, size_t Dim>
+void read_particle_file(const std::string &file_name, size_t frame, ParticleSystem<FP, Dim> &particles,
+                        const ParticleSelection &select = select_all_particles) {
+    using namespace input_reader_detail;
+    const MappedFile file(file_name);
+    TrajectoryHeader header{};
+    if (file.size() < sizeof(header)) fail(file_name, "not a particle or trajectory file");
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, "NBODYTRJ", sizeof(header.magic)) != 0) {
+        fail(file_name, "not a particle or trajectory file");
+    }
+    if (header.dimensions != Dim) {
+        fail(file_name, "the particles have " + std::to_string(header.dimensions) + " dimensions");
+    }
+    if (header.scalar_bytes != sizeof(float) && header.scalar_bytes != sizeof(double)) {
+        fail(file_name, "unsupported scalar size " + std::to_string(header.scalar_bytes));
+    }
+
+    const size_t n = header.num_particles;
+    if (header.frame_bytes != header.scalar_bytes * (1 + (2 * Dim + 1) * n)) fail(file_name, "inconsistent header");
+    if (file.size() < header.header_bytes + (frame + 1) * header.frame_bytes) {
+        fail(file_name, "frame " + std::to_string(frame) + " not found");
+    }
+    const auto [begin, end] = select(n);
+    if (begin > end || end > n) fail(file_name, "invalid particle range");
+
+    // Solo le pagine del blocco selezionato di ogni componente sono lette dal disco
+    const char *frame_data = file.data() + header.header_bytes + frame * header.frame_bytes + header.scalar_bytes;
+    const auto component = [&](size_t c) { return frame_data + (c * n + begin) * header.scalar_bytes; };
+    const auto copy = [&](size_t c, FP *destination) {
+        if (header.scalar_bytes == sizeof(float)) copy_values<float>(component(c), end - begin, destination);
+        else copy_values<double>(component(c), end - begin, destination);
+    };
+
+    particles = ParticleSystem<FP, Dim>(end - begin);
+    for (size_t d = 0; d < Dim; ++d) copy(d, particles.pos()[d]);
+    for (size_t d = 0; d < Dim; ++d) copy(Dim + d, particles.vel()[d]);
+    copy(2 * Dim, particles.mass());
+}
+
+// Legge il file di input: restituisce la configurazione, con "N" pari al numero di particelle del file (se
+// presente deve coincidere), e conserva in particles le particelle selezionate
+template<std::floating_point FP, size_t Dim>
+nlohmann::json read_input(const std::string &file_name, ParticleSystem<FP, Dim> &particles,
+                          const ParticleSelection &select = select_all_particles) {
+    using namespace input_reader_detail;
+    std::ifstream input(file_name, std::ios::binary);
+    if (!input.is_open()) throw std::runtime_error("Error: Unable to open file " + file_name);
+
+    json config = json::object();
+    particles.clear();
+    InputHandler<FP, Dim> handler(file_name, config, particles, select);
+    json::sax_parse(input, &handler);
+
+    size_t n = handler.count();
+    if (config.contains("particles_file")) {
+        if (n > 0) fail(file_name, "particles and particles_file cannot be used together");
+        const std::filesystem::path path = std::filesystem::path(file_name).parent_path() /
+                                           config["particles_file"].template get<std::string>();
+        n = read_particle_file_header(path.string()).num_particles;
+        if (config.contains("N") && config["N"] != n) {
+            fail(file_name, "N = " + config["N"].dump() + ", but " + path.string() + " holds " +
+                            std::to_string(n) + " particles");
+        }
+        read_particle_file<FP, Dim>(path.string(), config.value("particles_frame", size_t(0)), particles, select);
+    } else if (handler.selected_all()) {
+        // N assente o successivo alle particelle: si applica ora la selezione
+        const auto [begin, end] = select(n);
+        if (begin > 0 || end < n) {
+            ParticleSystem<FP, Dim> selected(end - begin);
+            for (size_t d = 0; d < Dim; ++d) {
+                std::copy(particles.pos()[d] + begin, particles.pos()[d] + end, selected.pos()[d]);
+                std::copy(particles.vel()[d] + begin, particles.vel()[d] + end, selected.vel()[d]);
+            }
+            std::copy(particles.mass() + begin, particles.mass() + end, selected.mass());
+            particles = std::move(selected);
+        }
+    }
+
+    if (config.contains("N") && config["N"] != n) {
+        fail(file_name, "N = " + config["N"].dump() + ", but the file describes " + std::to_string(n) +
+                        " particles");
+    }
+    if (n == 0) fail(file_name, "no particles");
+    config["N"] = n;
+    return config;
+}
+
+// Parametri dell'input che scelgono l'istanza del solver
+struct InputLayout {
+    size_t dimensions;
+    std::string precision; // Vuota se il file non indica "precision"
+};
+
+// Dimensione del problema (componenti della posizione della prima particella, oppure quella del file binario di
+// particelle) ed eventuale precisione. Il file non è analizzato oltre la prima posizione, per cui "precision" è
+// letta solo se precede "particles" (setup, che legge tutta la configurazione, segnala il caso contrario).
+inline InputLayout read_input_layout(const std::string &file_name) {
+    std::ifstream input(file_name, std::ios::binary);
+    if (!input.is_open()) throw std::runtime_error("Error: Unable to open file " + file_name);
+
+    input_reader_detail::DimensionProbe probe;
+    nlohmann::json::sax_parse(input, &probe);
+    if (probe.found) return {probe.dimensions, probe.precision};
+    if (!probe.particles_file.empty()) {
+        const std::filesystem::path path = std::filesystem::path(file_name).parent_path() / probe.particles_file;
+        return {read_particle_file_header(path.string()).dimensions, probe.precision};
+    }
+    throw std::runtime_error("Error: No particles in file " + file_name);
+}
+
+inline size_t read_input_dimensions(const std::string &file_name) {
+    return read_input_layout(file_name).dimensions;
+}
+
+#endif // TEAM_05_NBODY_INPUT_READER_HPP
@@ -1,19 +1,60 @@
-// Interfaccia astratta per tutti gli integratori numerici (es. Eulero, Newton).
-// Ogni integratore implementa un metodo per aggiornare le particelle.
-
-#ifndef INTEGRATOR_H
-#define INTEGRATOR_H
-
-#include "abstract_n_body.hpp"
-
-template<std::floating_point FP>
-class Integrator {
-public:
-    virtual ~Integrator() = default;
-    virtual void integrate(std::vector<Particle<FP>>& particles,
-                           const std::vector<std::vector<FP>>& forces,
-                           FP delta_t) = 0;
-};
-
-#endif //INTEGRATOR_H
-
+// Interfaccia astratta per tutti gli integratori numerici (es. Eulero, leapfrog, Yoshida).
+// Ogni integratore implementa un metodo per avanzare le particelle di un passo temporale.
+
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include "abstract_n_body.hpp"
+#include <cstdint>
+#include <functional>
+
+template<std::floating_point FP, size_t Dim>
+class Integrator {
+public:
+    // Ricalcola le forze sulle particelle nelle posizioni correnti
+    using ForceCallback = std::function<void(const ParticleSystem<FP, Dim> &, VectorField<FP, Dim> &)>;
+
+    virtual ~Integrator() = default;
+
+    // All'ingresso forces contiene le forze nelle posizioni correnti; all'uscita quelle nelle nuove posizioni,
+    // così che la valutazione finale di uno step sia riusata all'inizio del successivo
+    virtual void integrate(ParticleSystem<FP, Dim> &particles,
+                           VectorField<FP, Dim> &forces,
+                           const ForceCallback &compute_forces,
+                           FP delta_t) = 0;
+
+    virtual std::string name() const = 0;
+
+    // Numero di valutazioni delle forze per step (per gli integratori iterativi, il massimo)
+    virtual size_t force_evaluations() const = 0;
+
+    // Massimo di un valore tra tutti i processi: i solver distribuiti la impostano, così che i criteri di
+    // convergenza diano lo stesso risultato su tutti i rank (il calcolo delle forze è collettivo)
+    using MaxReduction = std::function<FP(FP)>;
+
+    void set_max_reduction(MaxReduction reduction) { max_reduction = std::move(reduction); }
+
+protected:
+    MaxReduction max_reduction = [](FP value) { return value; };
+};
+
+// Operazioni elementari sullo stato, definite nel sorgente del modello scelto (src/serial, src/openmp)
+
+// v += dt F / m
+template<std::floating_point FP, size_t Dim>
+void kick(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces, FP delta_t);
+
+// x += dt v
+template<std::floating_point FP, size_t Dim>
+void drift(ParticleSystem<FP, Dim> &particles, FP delta_t);
+
+// x += dt v + dt^2 / 2 F / m
+template<std::floating_point FP, size_t Dim>
+void drift_accelerated(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces, FP delta_t);
+
+// v_i += dt_k F_i / m_i, per le sole particelle i = active[k]
+template<std::floating_point FP, size_t Dim>
+void kick_active(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces,
+                 const std::vector<uint32_t> &active, const std::vector<FP> &delta_t);
+
+#endif //INTEGRATOR_H
@@ -0,0 +1,24 @@
+#ifndef TEAM_05_NBODY_INTEGRATOR_FACTORY_HPP
+#define TEAM_05_NBODY_INTEGRATOR_FACTORY_HPP
+
+#include "euler_explicit_integrator.hpp"
+#include "euler_implicit_integrator.hpp"
+#include "leapfrog_integrator.hpp"
+#include "velocity_verlet_integrator.hpp"
+#include "yoshida_integrator.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Crea l'integratore dal nome usato nel file di input
+template<std::floating_point FP, size_t Dim>
+std::unique_ptr<Integrator<FP, Dim>> make_integrator(const std::string &name) {
+    if (name == "euler") return std::make_unique<EulerExplicitIntegrator<FP, Dim>>();
+    if (name == "euler-implicit") return std::make_unique<EulerImplicitIntegrator<FP, Dim>>();
+    if (name == "leapfrog") return std::make_unique<LeapfrogIntegrator<FP, Dim>>();
+    if (name == "velocity-verlet") return std::make_unique<VelocityVerletIntegrator<FP, Dim>>();
+    if (name == "yoshida4") return std::make_unique<YoshidaIntegrator<FP, Dim>>();
+    throw std::invalid_argument("Unknown integrator: " + name);
+}
+
+#endif // TEAM_05_NBODY_INTEGRATOR_FACTORY_HPP
@@ -0,0 +1,152 @@
+#ifndef TEAM_05_NBODY_INTERACTION_HPP
+#define TEAM_05_NBODY_INTERACTION_HPP
+
+#include <cmath>
+#include <concepts>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// Legge di interazione tra due particelle, scelta a runtime dalle chiavi "softening" e "softening_length"
+enum class Softening {
+    NONE,    // Newton: F = G m_i m_j / r^2
+    PLUMMER, // Nucleo di Plummer: r^2 sostituito da r^2 + epsilon^2
+    SPLINE   // Spline cubica (Monaghan-Lattanzio, come in GADGET-2): newtoniana oltre h = 2.8 epsilon
+};
+
+inline Softening parse_softening(const std::string &softening) {
+    if (softening == "none") return Softening::NONE;
+    if (softening == "plummer") return Softening::PLUMMER;
+    if (softening == "spline") return Softening::SPLINE;
+    throw std::invalid_argument("Unknown softening: " + softening);
+}
+
+struct Interaction {
+    Softening softening = Softening::NONE;
+    double length = 0.0; // epsilon, la lunghezza di softening equivalente a quella di Plummer
+
+    Interaction() = default;
+
+    Interaction(Softening softening, double length) : softening(softening), length(length) {
+        if (softening != Softening::NONE && !(length > 0)) {
+            throw std::invalid_argument("The softening length must be positive");
+        }
+    }
+
+    // La stessa legge in un sistema di unità in cui le lunghezze sono moltiplicate per factor
+    Interaction scaled(double factor) const { return {softening, length * factor}; }
+
+    std::string name() const {
+        if (softening == Softening::NONE) return "newtonian";
+        std::ostringstream stream;
+        stream << (softening == Softening::PLUMMER ? "plummer" : "spline") << " softening (epsilon = " << length
+               << ")";
+        return stream.str();
+    }
+};
+
+// Policy delle leggi di interazione. Per una coppia a distanza r (r2 = r^2 > 0) e un numeratore c (G m_i m_j,
+// o la parte di esso che il chiamante non raccoglie) calcolano
+//   force     = c f(r),   con la forza su i dovuta a j pari a force (x_j - x_i)
+//   potential = c phi(r), con l'energia della coppia pari a -potential
+// Newton: f = 1/r^3, phi = 1/r. I kernel sono istanziati per ogni policy e la scelta avviene una volta per
+// chiamata (visit_interaction_law), senza diramazioni sulla legge nel ciclo sulle coppie.
+// Una legge definita dall'utente è una classe con la stessa interfaccia, aggiunta a visit_interaction_law.
+// vectorized indica che la legge ha la forma newtoniana in r^2 + softening_squared() (kernel vettoriali).
+template<typename Law, typename FP>
+concept InteractionLaw = requires(const Law law, FP numerator, FP r2, FP &force, FP &potential) {
+    { Law::vectorized } -> std::convertible_to<bool>;
+    law(numerator, r2, force, potential);
+};
+
+template<std::floating_point FP>
+class NewtonianLaw {
+public:
+    static constexpr bool vectorized = true;
+
+    explicit NewtonianLaw(const Interaction &) {}
+
+    void operator()(FP numerator, FP r2, FP &force, FP &potential) const {
+        force = numerator / (r2 * std::sqrt(r2));
+        potential = force * r2;
+    }
+
+    static constexpr FP softening_squared() { return 0; }
+};
+
+template<std::floating_point FP>
+class PlummerLaw {
+public:
+    static constexpr bool vectorized = true;
+
+    explicit PlummerLaw(const Interaction &interaction)
+            : epsilon_squared(static_cast<FP>(interaction.length * interaction.length)) {}
+
+    void operator()(FP numerator, FP r2, FP &force, FP &potential) const {
+        const FP softened = r2 + epsilon_squared;
+        force = numerator / (softened * std::sqrt(softened));
+        potential = force * softened;
+    }
+
+    FP softening_squared() const { return epsilon_squared; }
+
+private:
+    FP epsilon_squared;
+};
+
+// Nucleo a supporto compatto h: la forza è esattamente newtoniana per r >= h, il potenziale in 0 vale 1/epsilon
+template<std::floating_point FP>
+class SplineLaw {
+public:
+    static constexpr bool vectorized = false;
+
+    explicit SplineLaw(const Interaction &interaction)
+            : h(static_cast<FP>(2.8 * interaction.length)), h_inv(1 / h) {}
+
+    void operator()(FP numerator, FP r2, FP &force, FP &potential) const {
+        if (r2 >= h * h) {
+            force = numerator / (r2 * std::sqrt(r2));
+            potential = force * r2;
+            return;
+        }
+        const FP u = std::sqrt(r2) * h_inv, u2 = u * u;
+        const FP h3_inv = h_inv * h_inv * h_inv;
+        if (u < FP(0.5)) {
+            force = numerator * h3_inv * (FP(10.666666666667) + u2 * (FP(32.0) * u - FP(38.4)));
+            potential = numerator * h_inv * (FP(2.8) - u2 * (FP(5.333333333333) + u2 * (FP(6.4) * u - FP(9.6))));
+        } else {
+            force = numerator * h3_inv * (FP(21.333333333333) - FP(48.0) * u + FP(38.4) * u2 -
+                                          FP(10.666666666667) * u2 * u - FP(0.066666666667) / (u2 * u));
+            potential = numerator * h_inv * (FP(3.2) - FP(0.066666666667) / u -
+                                             u2 * (FP(10.666666666667) + u * (FP(-16.0) + u * (FP(9.6) -
+                                                                                           FP(2.133333333333) * u))));
+        }
+    }
+
+private:
+    FP h, h_inv;
+};
+
+template<template<typename> class Law>
+struct InteractionLawTag {};
+
+// Chiama function con il tag della policy scelta: function(InteractionLawTag<Law>{}) è istanziata per ogni legge
+template<typename Function>
+decltype(auto) visit_interaction_law(const Interaction &interaction, Function &&function) {
+    switch (interaction.softening) {
+        case Softening::PLUMMER: return function(InteractionLawTag<PlummerLaw>{});
+        case Softening::SPLINE: return function(InteractionLawTag<SplineLaw>{});
+        default: return function(InteractionLawTag<NewtonianLaw>{});
+    }
+}
+
+// Come visit_interaction_law, passando a function la policy già costruita per il tipo FP
+template<std::floating_point FP, typename Function>
+decltype(auto) with_interaction_law(const Interaction &interaction, Function &&function) {
+    return visit_interaction_law(interaction, [&]<template<typename> class Law>(InteractionLawTag<Law>) {
+        static_assert(InteractionLaw<Law<FP>, FP>);
+        return function(Law<FP>(interaction));
+    });
+}
+
+#endif // TEAM_05_NBODY_INTERACTION_HPP
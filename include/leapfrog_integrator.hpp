@@ -0,0 +1,24 @@
+#ifndef TEAM_05_NBODY_LEAPFROG_INTEGRATOR_HPP
+#define TEAM_05_NBODY_LEAPFROG_INTEGRATOR_HPP
+
+#include "integrator.hpp"
+
+// Leapfrog kick-drift-kick: mezzo kick, drift completo, nuove forze, mezzo kick.
+// Simplettico, reversibile e del secondo ordine, con una sola valutazione delle forze per step.
+template<std::floating_point FP, size_t Dim>
+class LeapfrogIntegrator : public Integrator<FP, Dim> {
+public:
+    void integrate(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                   const typename Integrator<FP, Dim>::ForceCallback &compute_forces, FP delta_t) override {
+        kick(particles, forces, delta_t / 2);
+        drift(particles, delta_t);
+        compute_forces(particles, forces);
+        kick(particles, forces, delta_t / 2);
+    }
+
+    std::string name() const override { return "leapfrog"; }
+
+    size_t force_evaluations() const override { return 1; }
+};
+
+#endif // TEAM_05_NBODY_LEAPFROG_INTEGRATOR_HPP
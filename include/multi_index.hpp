@@ -0,0 +1,158 @@
+#ifndef TEAM_05_NBODY_MULTI_INDEX_HPP
+#define TEAM_05_NBODY_MULTI_INDEX_HPP
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+// Tabelle dei multi-indici alpha in N^Dim di grado |alpha| <= p, usate dalle espansioni cartesiane di Taylor
+// del metodo dei multipoli. I multi-indici sono ordinati per grado crescente.
+template<size_t Dim>
+class MultiIndexTable {
+public:
+    using Index = std::array<int, Dim>;
+
+    // Coppia (alpha, beta) con indice k della loro somma o differenza
+    struct Pair {
+        size_t alpha, beta, combined;
+        double sign; // (-1)^|alpha| per M2L, 1 altrimenti
+    };
+
+    // Termine di D^gamma (1/|r|) = sum_mu coefficient * r^exponent / |r|^(2n+1)
+    struct DerivativeTerm {
+        size_t exponent; // Indice del multi-indice gamma - 2 mu
+        int n;           // |gamma| - |mu|
+        double coefficient;
+    };
+
+    explicit MultiIndexTable(int order);
+
+    int order() const { return p; }
+
+    size_t size() const { return indices.size(); }
+
+    const Index &operator[](size_t k) const { return indices[k]; }
+
+    int degree(size_t k) const { return degrees[k]; }
+
+    double inv_factorial(size_t k) const { return inv_factorials[k]; }
+
+    // Indice del multi-indice alpha, oppure size() se |alpha| > p
+    size_t lookup(const Index &alpha) const;
+
+    // beta <= alpha, con combined = alpha - beta (traslazioni M2M e L2L)
+    const std::vector<Pair> &shift_pairs() const { return shifts; }
+
+    // |alpha| + |beta| <= p, con combined = alpha + beta (traduzione M2L)
+    const std::vector<Pair> &translation_pairs() const { return translations; }
+
+    const std::vector<DerivativeTerm> &derivative_terms(size_t k) const { return derivatives[k]; }
+
+private:
+    int p;
+    std::vector<Index> indices;
+    std::vector<int> degrees;
+    std::vector<double> inv_factorials;
+    std::vector<size_t> dense; // Tabella densa (p+1)^Dim -> indice
+    std::vector<Pair> shifts;
+    std::vector<Pair> translations;
+    std::vector<std::vector<DerivativeTerm>> derivatives;
+
+    size_t dense_index(const Index &alpha) const {
+        size_t key = 0;
+        for (size_t d = 0; d < Dim; ++d) key = key * (p + 1) + alpha[d];
+        return key;
+    }
+};
+
+template<size_t Dim>
+MultiIndexTable<Dim>::MultiIndexTable(int order) : p(order) {
+    if (order < 0) throw std::invalid_argument("The expansion order must be non-negative");
+
+    auto factorial = [](int n) {
+        double result = 1.0;
+        for (int k = 2; k <= n; ++k) result *= k;
+        return result;
+    };
+
+    // Enumerazione per grado crescente
+    dense.assign(1, 0);
+    for (size_t d = 0; d < Dim; ++d) dense.resize(dense.size() * (p + 1));
+    for (int degree = 0; degree <= p; ++degree) {
+        Index alpha{};
+        // Visita di tutti i multi-indici con componenti <= degree, tenendo quelli di grado esatto
+        while (true) {
+            int sum = 0;
+            for (size_t d = 0; d < Dim; ++d) sum += alpha[d];
+            if (sum == degree) {
+                double alpha_factorial = 1.0;
+                for (size_t d = 0; d < Dim; ++d) alpha_factorial *= factorial(alpha[d]);
+                dense[dense_index(alpha)] = indices.size();
+                indices.push_back(alpha);
+                degrees.push_back(degree);
+                inv_factorials.push_back(1.0 / alpha_factorial);
+            }
+            size_t d = 0;
+            while (d < Dim && ++alpha[d] > degree) alpha[d++] = 0;
+            if (d == Dim) break;
+        }
+    }
+
+    // Coppie per le traslazioni e le traduzioni
+    for (size_t a = 0; a < size(); ++a) {
+        for (size_t b = 0; b < size(); ++b) {
+            Index difference, sum;
+            bool below = true;
+            for (size_t d = 0; d < Dim; ++d) {
+                difference[d] = indices[a][d] - indices[b][d];
+                sum[d] = indices[a][d] + indices[b][d];
+                below = below && difference[d] >= 0;
+            }
+            if (below) shifts.push_back({a, b, lookup(difference), 1.0});
+            if (degrees[a] + degrees[b] <= p)
+                translations.push_back({a, b, lookup(sum), degrees[a] % 2 ? -1.0 : 1.0});
+        }
+    }
+
+    // Derivate di 1/|r|: D^gamma f(|r|^2), con f(s) = s^(-1/2), vale
+    // sum_mu prod_d [gamma_d! / (mu_d! (gamma_d - 2 mu_d)!)] (2 r)^(gamma - 2 mu) f^(|gamma| - |mu|)(|r|^2),
+    // con f^(n)(s) = (-1)^n (2n - 1)!! / 2^n s^(-(2n + 1) / 2)
+    derivatives.resize(size());
+    for (size_t g = 0; g < size(); ++g) {
+        const Index &gamma = indices[g];
+        Index mu{};
+        while (true) {
+            Index exponent;
+            int mu_degree = 0;
+            double coefficient = 1.0;
+            for (size_t d = 0; d < Dim; ++d) {
+                exponent[d] = gamma[d] - 2 * mu[d];
+                mu_degree += mu[d];
+                coefficient *= factorial(gamma[d]) / (factorial(mu[d]) * factorial(exponent[d]));
+            }
+            const int n = degrees[g] - mu_degree;
+            double double_factorial = 1.0;
+            for (int k = 2 * n - 1; k > 1; k -= 2) double_factorial *= k;
+            coefficient *= (n % 2 ? -1.0 : 1.0) * double_factorial;
+            for (int k = 0; k < mu_degree; ++k) coefficient /= 2.0;
+            derivatives[g].push_back({lookup(exponent), n, coefficient});
+
+            size_t d = 0;
+            while (d < Dim && 2 * ++mu[d] > gamma[d]) mu[d++] = 0;
+            if (d == Dim) break;
+        }
+    }
+}
+
+template<size_t Dim>
+size_t MultiIndexTable<Dim>::lookup(const Index &alpha) const {
+    int sum = 0;
+    for (size_t d = 0; d < Dim; ++d) {
+        if (alpha[d] < 0) return size();
+        sum += alpha[d];
+    }
+    return sum > p ? size() : dense[dense_index(alpha)];
+}
+
+#endif // TEAM_05_NBODY_MULTI_INDEX_HPP
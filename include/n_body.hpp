@@ -0,0 +1,380 @@
+#ifndef TEAM_05_NBODY_NBODY_HPP
+#define TEAM_05_NBODY_NBODY_HPP
+
+#include "abstract_n_body.hpp"
+#include "integrator.hpp"
+#include "integrator_factory.hpp"
+#include "force_evaluator_factory.hpp"
+#include "async_trajectory_writer.hpp"
+#include "block_timestepper.hpp"
+#include "profiler.hpp"
+#include "input_reader.hpp"
+#include "spatial_order.hpp"
+#include "json.hpp"
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using json = nlohmann::json;
+
+// Classe generica N-Body, con dimensione del problema fissata a tempo di compilazione
+template<std::floating_point FP, size_t Dim>
+class NBody : public AbstractNbody<FP> {
+public:
+    explicit NBody(std::unique_ptr<Integrator<FP, Dim>> integrator =
+            std::make_unique<EulerExplicitIntegrator<FP, Dim>>())
+            : AbstractNbody<FP>(0, 0.0), integrator(std::move(integrator)) {}
+
+    void setup(std::string file_name) override;
+
+    void solve() override;
+
+    void restart(const std::string &checkpoint_file) override;
+
+protected:
+    void output(size_t step) override;
+
+private:
+    ParticleSystem<FP, Dim> particles; // Layout SoA: posizioni, velocità e masse contigue
+    std::unique_ptr<Integrator<FP, Dim>> integrator;
+    std::unique_ptr<ForceEvaluator<FP, Dim>> force_evaluator; // Somma diretta, Barnes-Hut o FMM, scelto in setup
+    Interaction interaction; // Legge di interazione (softening), comune a tutti i metodi
+    VectorField<FP, Dim> forces; // Forze su ogni particella, layout SoA [dimensione][particella]
+    AsyncTrajectoryWriter<FP, Dim> trajectory; // Aperto al primo snapshot binario
+    std::unique_ptr<BlockTimestepper<FP, Dim>> block_timestepper; // Passi individuali a blocchi, opzionale
+    DiagnosticsWriter<FP, Dim> diagnostics; // Aperto all'inizio di solve se diagnostics_every > 0
+    std::optional<uint64_t> resume_frames;  // Frame della traiettoria da conservare dopo restart
+
+    // Riordinamento periodico lungo la curva di Morton: particle_ids[i] è l'indice nel file di input della
+    // particella in posizione i (vuoto finché le particelle sono nell'ordine del file)
+    size_t reorder_every = 0;
+    std::vector<uint32_t> particle_ids;
+    std::vector<uint32_t> reorder_permutation;
+    ParticleSystem<FP, Dim> output_particles; // Copia nell'ordine del file di input, per gli snapshot
+
+    void compute_forces() {
+        NBODY_PROFILE_SCOPE("force");
+        force_evaluator->compute_forces(particles, forces);
+    }
+
+    // Misura le grandezze conservate dopo step passi completati
+    void write_diagnostics(size_t step);
+
+    // Salva lo stato dopo step passi completati
+    void write_checkpoint(size_t step);
+
+    // Ordina le particelle lungo la curva di Morton, con le forze correnti e lo stato dei passi a blocchi
+    void reorder() {
+        NBODY_PROFILE_SCOPE("reorder");
+        morton_order(particles, reorder_permutation);
+        permute(particles, reorder_permutation);
+        permute(forces, reorder_permutation);
+        if (block_timestepper) block_timestepper->permute(reorder_permutation);
+        if (particle_ids.empty()) particle_ids = reorder_permutation;
+        else permute(particle_ids.data(), reorder_permutation);
+    }
+
+    // Le particelle nell'ordine del file di input, come sono scritte negli snapshot
+    const ParticleSystem<FP, Dim> &original_order() {
+        if (particle_ids.empty()) return particles;
+        unpermute(particles, particle_ids, output_particles);
+        return output_particles;
+    }
+
+    // Integratore e calcolo delle forze, come descritti all'avvio e nei checkpoint
+    std::string configuration() const {
+        return "integrator: " + (block_timestepper ? block_timestepper->name() : integrator->name()) +
+               ", forces: " + force_evaluator->name() +
+               (reorder_every > 0 ? ", morton order every " + std::to_string(reorder_every) + " step(s)" : "");
+    }
+
+    // Somma O(N^2) sulle coppie, usata solo se il calcolo delle forze non fornisce l'energia potenziale
+    // (definito nel sorgente del modello scelto: src/serial, src/openmp)
+    FP calculate_potential_energy();
+};
+
+// Il problema 2D è l'istanza con Dim = 2
+template<std::floating_point FP>
+using NBody2D = NBody<FP, 2>;
+
+// Metodo setup: Lettura dei dati da file JSON
+template<std::floating_point FP, size_t Dim>
+void NBody<FP, Dim>::setup(std::string file_name) {
+    NBODY_PROFILE_SCOPE("setup");
+    // Legge la configurazione e, in streaming o dal file binario, le particelle
+    json data = read_input(file_name, particles);
+    data.update(this->overrides);
+    this->check_precision(data);
+
+    this->N = data["N"];
+    this->delta_t = data["delta_t"];
+    this->t_max = data["max_time"];
+
+    // Integratore: "euler" (default del costruttore), "euler-implicit", "leapfrog", "velocity-verlet", "yoshida4"
+    if (data.contains("integrator")) integrator = make_integrator<FP, Dim>(data["integrator"]);
+
+    // Passi temporali individuali a blocchi (leapfrog), opzionali: delta_t è il passo del livello 0
+    block_timestepper.reset();
+    if (data.value("block_timesteps", false)) {
+        if (data.value("integrator", "leapfrog") != "leapfrog") {
+            throw std::invalid_argument("Block timesteps require the leapfrog integrator");
+        }
+        block_timestepper = std::make_unique<BlockTimestepper<FP, Dim>>(data.value("max_timestep_level", size_t(8)),
+                                                                        data.value("timestep_accuracy", FP(0.05)));
+    }
+
+    // Softening dell'interazione: "none" (default), "plummer" o "spline", con lunghezza "softening_length"
+    interaction = Interaction(parse_softening(data.value("softening", "none")), data.value("softening_length", 0.0));
+
+    // Metodo di calcolo delle forze: "direct" (default), "barnes-hut" o "fmm"
+    const std::string force_engine = data.value("force_engine", "direct");
+    force_evaluator = make_force_evaluator<FP, Dim>(data, this->G, interaction);
+
+    // Inizializza forze
+    forces.resize(this->N);
+
+    // Riordinamento spaziale delle particelle ogni reorder_every step (0: mai), per la località in memoria;
+    // gli snapshot restano nell'ordine del file di input
+    reorder_every = data.value("reorder_every", size_t(0));
+    particle_ids.clear();
+
+    // Numero di thread (solo con OpenMP; se assente vale OMP_NUM_THREADS) e messaggi durante la simulazione
+#ifdef _OPENMP
+    if (data.contains("threads")) omp_set_num_threads(data["threads"].get<int>());
+#endif
+    this->verbosity = parse_verbosity(data.value("verbosity", "normal"));
+
+    // Formato e frequenza degli snapshot
+    this->output_format = parse_output_format(data.value("output_format", "binary"));
+    this->output_every = data.value("output_every", size_t(1));
+    if (this->output_every == 0) throw std::invalid_argument("output_every must be positive");
+    this->output_queue_depth = data.value("output_queue_depth", size_t(2));
+
+    // Frequenza e formato della diagnostica (energia, quantità di moto, momento angolare, centro di massa)
+    this->diagnostics_every = data.value("diagnostics_every", size_t(1));
+    this->diagnostics_format = parse_diagnostics_format(data.value("diagnostics_format", "csv"));
+
+    // Checkpoint periodici dello stato completo, per riprendere la simulazione con restart
+    this->checkpoint_every = data.value("checkpoint_every", size_t(0));
+    this->checkpoint_filename = data.value("checkpoint_file", std::string(DEF_CHECKPOINT_FILENAME));
+    this->start_step = 0;
+    resume_frames.reset();
+
+    // Accuratezza del FMM per gli ordini 1..fmm_order rispetto alla somma diretta, opzionale
+    if (force_engine == "fmm" && data.value("fmm_report", false)) {
+        fmm_accuracy_report(particles, this->G, data.value("fmm_order", 4), data.value("leaf_size", size_t(64)),
+                            data.value("theta", FP(0.6)), interaction, std::cout);
+    }
+
+    // Errore e tempo dei kernel in precisione ridotta e mista rispetto alla precisione piena, opzionale
+    if (force_engine == "direct" && data.value("precision_report", false)) {
+        kernel_precision_report(particles, this->G, interaction, std::cout);
+    }
+
+    // Inizializza tempo
+    this->time.clear();
+    this->time.push_back(0.0);
+    for (FP t = this->delta_t; t <= this->t_max; t += this->delta_t) {
+        this->time.push_back(t);
+    }
+}
+
+// Metodo solve: Usa l'integratore
+template<std::floating_point FP, size_t Dim>
+void NBody<FP, Dim>::solve() {
+    if (this->logs(Verbosity::NORMAL)) {
+        std::cout << "Starting simulation with " << this->N << " particles and delta_t = " << this->delta_t
+                  << " (" << 8 * sizeof(FP) << "-bit), " << configuration() << "\n";
+        std::cout << "Writing a snapshot every " << this->output_every << " step(s) to '"
+                  << (this->output_format == OutputFormat::BINARY ? this->trajectory_filename
+                                                                  : this->output_filename_prefix + "XXXXX.csv")
+                  << "'\n";
+    }
+
+    if (this->checkpoint_every > 0 && this->logs(Verbosity::NORMAL)) {
+        std::cout << "Writing a checkpoint every " << this->checkpoint_every << " step(s) to '"
+                  << this->checkpoint_filename << "'\n";
+    }
+
+    // Forze iniziali; in seguito l'integratore le ricalcola nelle nuove posizioni. Dopo restart le forze, l'ordine
+    // delle particelle e il flusso di diagnostica sono quelli del checkpoint.
+    if (this->start_step == 0 && reorder_every > 0) reorder();
+    if (this->start_step == 0) compute_forces();
+    if (this->diagnostics_every > 0) {
+        const std::string diagnostics_file = this->diagnostics_filename +
+                                             diagnostics_extension(this->diagnostics_format);
+        if (this->start_step == 0) diagnostics.open(diagnostics_file, this->diagnostics_format);
+        if (this->logs(Verbosity::NORMAL)) {
+            std::cout << "Writing diagnostics every " << this->diagnostics_every << " step(s) to '"
+                      << diagnostics_file << "'\n";
+        }
+        if (this->start_step == 0) write_diagnostics(0);
+    }
+    const auto force_callback = [this](const ParticleSystem<FP, Dim> &state, VectorField<FP, Dim> &result) {
+        NBODY_PROFILE_SCOPE("force");
+        force_evaluator->compute_forces(state, result);
+    };
+    const auto active_force_callback = [this](const ParticleSystem<FP, Dim> &state, VectorField<FP, Dim> &result,
+                                              const std::vector<uint32_t> &active) {
+        NBODY_PROFILE_SCOPE("force");
+        force_evaluator->compute_active_forces(state, result, active);
+    };
+
+    for (size_t step = this->start_step; step < this->time.size(); ++step) {
+        if (this->logs(Verbosity::VERBOSE)) std::cout << "Step " << step + 1 << "/" << this->time.size() << "...\n";
+        {
+            NBODY_PROFILE_SCOPE("integrate");
+            if (block_timestepper) {
+                block_timestepper->advance(particles, forces, active_force_callback, this->delta_t);
+            } else {
+                integrator->integrate(particles, forces, force_callback, this->delta_t);
+            }
+        }
+
+        const bool last_step = step + 1 == this->time.size();
+        if (reorder_every > 0 && (step + 1) % reorder_every == 0) reorder();
+        if (this->diagnostics_every > 0 && ((step + 1) % this->diagnostics_every == 0 || last_step)) {
+            write_diagnostics(step + 1);
+        }
+
+        if (step % this->output_every == 0) output(step);
+
+        if (this->checkpoint_every > 0 && ((step + 1) % this->checkpoint_every == 0 || last_step)) {
+            write_checkpoint(step + 1);
+        }
+    }
+    trajectory.close();
+    if (diagnostics.is_open()) {
+        diagnostics.close();
+        if (this->logs(Verbosity::NORMAL)) {
+            std::cout << "Energy: initial = " << diagnostics.first().total_energy() << ", final = "
+                      << diagnostics.latest().total_energy() << ", max relative change = "
+                      << diagnostics.max_relative_energy_change() << "\n";
+        }
+    }
+    if (block_timestepper && this->logs(Verbosity::NORMAL)) block_timestepper->report(std::cout, this->delta_t);
+    if (trajectory.stall_count() > 0 && this->logs(Verbosity::NORMAL)) {
+        std::cout << "The solver waited for the trajectory writer at " << trajectory.stall_count()
+                  << " snapshot(s): consider a larger output_queue_depth\n";
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void NBody<FP, Dim>::write_diagnostics(size_t step) {
+    NBODY_PROFILE_SCOPE("diagnostics");
+    // L'ultimo calcolo delle forze è avvenuto nelle posizioni correnti
+    const std::optional<FP> potential = force_evaluator->potential_energy();
+    diagnostics.write(step, FP(step) * this->delta_t,
+                      measure_diagnostics(particles, potential ? *potential : calculate_potential_energy()));
+}
+
+// I frame e le misure già prodotti sono completati prima del checkpoint, che ne registra il numero
+template<std::floating_point FP, size_t Dim>
+void NBody<FP, Dim>::write_checkpoint(size_t step) {
+    NBODY_PROFILE_SCOPE("checkpoint");
+    if (trajectory.is_open()) trajectory.flush();
+
+    CheckpointWriter checkpoint(this->checkpoint_filename);
+    write_particle_state(checkpoint, particles, forces);
+    checkpoint.write_string(configuration());
+    checkpoint.write_value(uint8_t(block_timestepper != nullptr));
+    if (block_timestepper) block_timestepper->save_state(checkpoint);
+    write_particle_order(checkpoint, particle_ids);
+    diagnostics.save_state(checkpoint);
+    checkpoint.commit(make_checkpoint_header<FP, Dim>(particles.size(), step, FP(step) * this->delta_t,
+                                                      this->delta_t));
+}
+
+// Metodo restart: sostituisce lo stato letto da setup con quello del checkpoint
+template<std::floating_point FP, size_t Dim>
+void NBody<FP, Dim>::restart(const std::string &checkpoint_file) {
+    NBODY_PROFILE_SCOPE("restart");
+    CheckpointReader checkpoint(checkpoint_file);
+    checkpoint.check<FP, Dim>(this->delta_t);
+    const CheckpointHeader &header = checkpoint.header();
+    if (header.num_particles != this->N) {
+        throw std::invalid_argument("The checkpoint " + checkpoint_file + " has " +
+                                    std::to_string(header.num_particles) + " particles");
+    }
+    if (header.step >= this->time.size()) {
+        throw std::invalid_argument("The checkpoint " + checkpoint_file + " is at the end of the simulation: "
+                                    "increase max_time to continue it");
+    }
+
+    read_particle_state(checkpoint, particles, forces);
+    const std::string checkpoint_configuration = checkpoint.read_string();
+    if (checkpoint_configuration != configuration()) {
+        std::cerr << "Warning: the checkpoint was written with " << checkpoint_configuration
+                  << ": the continuation will not be bit-identical\n";
+    }
+    if ((checkpoint.read_value<uint8_t>() != 0) != (block_timestepper != nullptr)) {
+        throw std::invalid_argument("The checkpoint " + checkpoint_file + " was written with" +
+                                    (block_timestepper ? "out" : "") + " block timesteps");
+    }
+    if (block_timestepper) block_timestepper->load_state(checkpoint);
+    particle_ids = read_particle_order(checkpoint);
+    if (this->diagnostics_every > 0) {
+        diagnostics.resume(this->diagnostics_filename + diagnostics_extension(this->diagnostics_format),
+                           this->diagnostics_format, checkpoint);
+    }
+
+    this->start_step = header.step;
+    if (this->output_format == OutputFormat::BINARY) {
+        resume_frames = (header.step + this->output_every - 1) / this->output_every;
+    }
+    if (this->logs(Verbosity::NORMAL)) {
+        std::cout << "Resuming from step " << header.step << " (t = " << header.time << ") of '" << checkpoint_file
+                  << "'\n";
+    }
+}
+
+// Metodo output: Stampa i risultati
+template<std::floating_point FP, size_t Dim>
+void NBody<FP, Dim>::output(size_t step) {
+    NBODY_PROFILE_SCOPE("output");
+    if (this->output_format == OutputFormat::BINARY) {
+        if (!trajectory.is_open()) {
+            trajectory.open(this->trajectory_filename, particles.size(), this->output_queue_depth, resume_frames);
+        }
+        trajectory.write_frame(this->time[step], original_order());
+        return;
+    }
+
+    std::ostringstream timestep_filename_stream;
+    timestep_filename_stream << this->output_filename_prefix << std::setfill('0') << std::setw(5) << step << ".csv";
+    const std::string timestep_filename = timestep_filename_stream.str();
+
+    std::ofstream output_file(timestep_filename);
+    if (!output_file.is_open()) {
+        throw std::runtime_error("Error: Unable to open the output file!");
+    }
+
+    // Scrive l'header dinamico
+    output_file << "t";
+    for (size_t d = 0; d < Dim; ++d) output_file << ",x" << d;
+    for (size_t d = 0; d < Dim; ++d) output_file << ",v" << d;
+    output_file << ",m\n";
+
+    // Scrive i dati per ogni particella
+    const ParticleSystem<FP, Dim> &snapshot = original_order();
+    const auto &pos = snapshot.pos();
+    const auto &vel = snapshot.vel();
+    const FP *mass = snapshot.mass();
+    for (size_t i = 0; i < snapshot.size(); ++i) {
+        output_file << this->time[step]; // Tempo
+        for (size_t d = 0; d < Dim; ++d) output_file << "," << pos[d][i];
+        for (size_t d = 0; d < Dim; ++d) output_file << "," << vel[d][i];
+        output_file << "," << mass[i] << "\n";
+    }
+    NBODY_PROFILE_COUNT("bytes written", output_file.tellp());
+
+    output_file.close();
+}
+
+#endif // TEAM_05_NBODY_NBODY_HPP
@@ -0,0 +1,118 @@
+#ifndef TEAM_05_NBODY_NBODY_MPI_HPP
+#define TEAM_05_NBODY_NBODY_MPI_HPP
+
+#include "abstract_n_body.hpp"
+#include "integrator.hpp"
+#include "integrator_factory.hpp"
+#include "interaction.hpp"
+#include "async_trajectory_writer.hpp"
+#include "profiler.hpp"
+#include <mpi.h>
+#include <memory>
+#include <optional>
+#include <string>
+
+// Strategia di scambio delle posizioni tra i rank
+enum class ExchangeMode {
+    ALLGATHER, // Ogni rank raccoglie tutte le posizioni con MPI_Allgatherv (memoria O(N) per rank)
+    RING       // I blocchi circolano lungo un anello di P-1 passi (memoria O(N/P) per rank)
+};
+
+// Modalità di scrittura degli snapshot
+enum class OutputMode {
+    COLLECTIVE, // Un unico file (per step in CSV, per l'intera traiettoria in binario), scritto con MPI-IO
+    PER_RANK    // Un file per rank (e per step in CSV)
+};
+
+// Classe N-Body a memoria distribuita: ogni rank possiede un blocco contiguo di particelle,
+// calcola le forze sul proprio blocco e lo integra localmente.
+template<std::floating_point FP, size_t Dim>
+class NBodyMPI : public AbstractNbody<FP> {
+public:
+    NBodyMPI(MPI_Comm communicator, ExchangeMode exchange_mode = ExchangeMode::ALLGATHER,
+             OutputMode output_mode = OutputMode::COLLECTIVE,
+             std::unique_ptr<Integrator<FP, Dim>> integrator = std::make_unique<EulerExplicitIntegrator<FP, Dim>>());
+
+    void setup(std::string file_name) override;
+
+    void solve() override;
+
+    // Il rank 0 legge il checkpoint e distribuisce i blocchi: la decomposizione può differire da quella della
+    // simulazione che lo ha scritto (il risultato è identico bit per bit solo con lo stesso numero di rank)
+    void restart(const std::string &checkpoint_file) override;
+
+protected:
+    void output(size_t step) override;
+
+private:
+    MPI_Comm comm;
+    int rank = 0;
+    int size = 1;
+
+    ParticleSystem<FP, Dim> particles; // Blocco locale di particelle, layout SoA
+    std::unique_ptr<Integrator<FP, Dim>> integrator;
+    ExchangeMode exchange_mode;
+    OutputMode output_mode;
+    Interaction interaction; // Legge di interazione (softening)
+
+    // Decomposizione a blocchi: particles contiene solo le particelle locali
+    std::vector<int> counts;  // Numero di particelle per rank
+    std::vector<int> offsets; // Indice globale della prima particella di ogni rank
+    size_t local_n = 0;
+    size_t offset = 0;
+
+    VectorField<FP, Dim> forces;         // Forze sulle particelle locali
+    FP local_potential = 0.0;            // Energia potenziale delle particelle locali (metà di ogni coppia)
+    aligned_vector<FP> global_pos;  // Posizioni di tutte le particelle, [dimensione][particella] (solo ALLGATHER)
+    aligned_vector<FP> global_mass; // Masse di tutte le particelle (solo ALLGATHER)
+    aligned_vector<FP> ring_buffer; // Blocco in transito (solo RING): componenti delle posizioni seguite dalle masse
+
+    // Traiettoria binaria: file condiviso (COLLECTIVE) oppure file del rank (PER_RANK)
+    MPI_File trajectory_file = MPI_FILE_NULL;
+    MPI_Datatype frame_type = MPI_DATATYPE_NULL; // Vista del file: tempo (rank 0) e blocco locale delle componenti
+    size_t frame_size = 0;                       // Valori scritti dal rank in ogni frame
+    size_t frames_written = 0;
+    std::vector<aligned_vector<FP>> frame_buffers; // Frame in scrittura con MPI_File_iwrite_at_all
+    std::vector<MPI_Request> frame_requests;
+    AsyncTrajectoryWriter<FP, Dim> rank_trajectory;
+    DiagnosticsWriter<FP, Dim> diagnostics; // Solo sul rank 0
+    std::optional<uint64_t> resume_frames;  // Frame della traiettoria da conservare dopo restart
+
+    void open_trajectory();
+
+    void output_binary(size_t step);
+
+    void close_trajectory();
+
+    void write_diagnostics(size_t step);
+
+    // Raccoglie lo stato sul rank 0, che scrive il checkpoint dopo step passi completati
+    void write_checkpoint(size_t step);
+
+    std::string configuration() const {
+        return "integrator: " + integrator->name() + ", forces: direct (" +
+               (exchange_mode == ExchangeMode::RING ? "ring" : "allgather") + " exchange" +
+               (interaction.softening == Softening::NONE ? "" : ", " + interaction.name()) + ")";
+    }
+
+    void compute_forces();
+
+    void compute_forces_allgather();
+
+    void compute_forces_ring();
+
+    // Accumula sulle particelle locali le forze esercitate da un blocco di sorgenti,
+    // le cui componenti sono distanti src_stride elementi l'una dall'altra
+    void accumulate_forces(const FP *src_pos, size_t src_stride, const FP *src_mass, size_t src_count,
+                           size_t src_offset) {
+        with_interaction_law<FP>(interaction, [&](const auto &law) {
+            accumulate_forces(law, src_pos, src_stride, src_mass, src_count, src_offset);
+        });
+    }
+
+    template<typename Law>
+    void accumulate_forces(const Law &law, const FP *src_pos, size_t src_stride, const FP *src_mass,
+                           size_t src_count, size_t src_offset);
+};
+
+#endif // TEAM_05_NBODY_NBODY_MPI_HPP
@@ -0,0 +1,178 @@
+#ifndef TEAM_05_NBODY_ORTHANT_TREE_HPP
+#define TEAM_05_NBODY_ORTHANT_TREE_HPP
+
+#include "particle_system.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// Albero con 2^Dim figli per nodo (quadtree in 2D, octree in 3D), usato dai metodi ad albero.
+// È ricostruito a ogni step in un'arena di nodi, la cui capacità è mantenuta tra uno step e l'altro.
+// I figli di un nodo hanno indici maggiori del padre: visitare l'arena all'indietro è una visita in post-ordine.
+template<std::floating_point FP, size_t Dim>
+class OrthantTree {
+public:
+    static constexpr size_t num_orthants = size_t(1) << Dim;
+    static constexpr size_t max_depth = 48;
+
+    struct Node {
+        Vec<FP, Dim> center; // Centro geometrico della cella
+        Vec<FP, Dim> com;    // Centro di massa
+        FP half_size;        // Metà del lato della cella
+        FP radius;           // Distanza massima delle particelle della cella dal centro di massa
+        FP mass;
+        uint32_t begin, end; // Particelle della cella: order[begin, end)
+        uint32_t first_child; // Indice nell'arena del primo figlio (i figli non vuoti sono contigui)
+        uint32_t child_count; // 0 per le foglie
+
+        bool is_leaf() const { return child_count == 0; }
+    };
+
+    void build(const ParticleSystem<FP, Dim> &particles, size_t leaf_size);
+
+    const std::vector<Node> &nodes() const { return arena; }
+
+    // Permutazione delle particelle in ordine di albero
+    const std::vector<uint32_t> &order() const { return permutation; }
+
+private:
+    std::vector<Node> arena;
+    std::vector<uint32_t> permutation;
+    std::vector<uint32_t> scratch; // Buffer per la partizione delle particelle tra i figli
+
+    void build_node(const std::array<const FP *, Dim> &pos, const FP *mass, size_t leaf_size, uint32_t index,
+                    size_t depth);
+};
+
+template<std::floating_point FP, size_t Dim>
+void OrthantTree<FP, Dim>::build(const ParticleSystem<FP, Dim> &particles, size_t leaf_size) {
+    NBODY_PROFILE_SCOPE("tree build");
+    const size_t n = particles.size();
+    const auto pos = particles.pos().pointers();
+
+    permutation.resize(n);
+    scratch.resize(n);
+    for (size_t i = 0; i < n; ++i) permutation[i] = static_cast<uint32_t>(i);
+
+    arena.clear();
+    if (n == 0) return;
+
+    // Cella radice: il cubo che racchiude tutte le particelle
+    Node root{};
+    FP half_size = 0.0;
+    for (size_t d = 0; d < Dim; ++d) {
+        auto [min, max] = std::minmax_element(pos[d], pos[d] + n);
+        root.center[d] = (*min + *max) / 2;
+        half_size = std::max(half_size, (*max - *min) / 2);
+    }
+    root.half_size = half_size * (1 + 1e-6); // Margine per le particelle sul bordo
+    root.begin = 0;
+    root.end = static_cast<uint32_t>(n);
+
+    arena.push_back(root);
+    build_node(pos, particles.mass(), leaf_size, 0, 0);
+}
+
+template<std::floating_point FP, size_t Dim>
+void OrthantTree<FP, Dim>::build_node(const std::array<const FP *, Dim> &pos, const FP *mass, size_t leaf_size,
+                                      uint32_t index, size_t depth) {
+    const Node node = arena[index]; // Copia: l'arena può essere riallocata aggiungendo i figli
+    const size_t count = node.end - node.begin;
+
+    auto orthant = [&](uint32_t p) {
+        size_t code = 0;
+        for (size_t d = 0; d < Dim; ++d)
+            if (pos[d][p] >= node.center[d]) code |= size_t(1) << d;
+        return code;
+    };
+
+    // Foglia: massa, centro di massa e raggio calcolati direttamente
+    if (count <= leaf_size || depth == max_depth || node.half_size <= 0) {
+        FP total_mass = 0.0;
+        Vec<FP, Dim> weighted{};
+        for (uint32_t k = node.begin; k < node.end; ++k) {
+            const uint32_t p = permutation[k];
+            total_mass += mass[p];
+            for (size_t d = 0; d < Dim; ++d) weighted[d] += mass[p] * pos[d][p];
+        }
+        Node &leaf = arena[index];
+        leaf.mass = total_mass;
+        for (size_t d = 0; d < Dim; ++d) leaf.com[d] = total_mass > 0 ? weighted[d] / total_mass : node.center[d];
+
+        FP radius_squared = 0.0;
+        for (uint32_t k = node.begin; k < node.end; ++k) {
+            FP dist_squared = 0.0;
+            for (size_t d = 0; d < Dim; ++d) {
+                const FP diff = pos[d][permutation[k]] - leaf.com[d];
+                dist_squared += diff * diff;
+            }
+            radius_squared = std::max(radius_squared, dist_squared);
+        }
+        leaf.radius = std::sqrt(radius_squared);
+        leaf.child_count = 0;
+        return;
+    }
+
+    // Partizione delle particelle tra gli ortanti (counting sort)
+    std::array<uint32_t, num_orthants> counts{};
+    for (uint32_t k = node.begin; k < node.end; ++k) ++counts[orthant(permutation[k])];
+
+    std::array<uint32_t, num_orthants> offsets;
+    offsets[0] = node.begin;
+    for (size_t o = 1; o < num_orthants; ++o) offsets[o] = offsets[o - 1] + counts[o - 1];
+
+    std::array<uint32_t, num_orthants> cursor = offsets;
+    for (uint32_t k = node.begin; k < node.end; ++k) scratch[cursor[orthant(permutation[k])]++] = permutation[k];
+    std::copy(scratch.begin() + node.begin, scratch.begin() + node.end, permutation.begin() + node.begin);
+
+    // Figli non vuoti, allocati contigui nell'arena
+    const auto first_child = static_cast<uint32_t>(arena.size());
+    uint32_t child_count = 0;
+    for (size_t o = 0; o < num_orthants; ++o) {
+        if (counts[o] == 0) continue;
+        Node child{};
+        child.half_size = node.half_size / 2;
+        for (size_t d = 0; d < Dim; ++d)
+            child.center[d] = node.center[d] + ((o >> d) & 1 ? child.half_size : -child.half_size);
+        child.begin = offsets[o];
+        child.end = offsets[o] + counts[o];
+        arena.push_back(child);
+        ++child_count;
+    }
+    arena[index].first_child = first_child;
+    arena[index].child_count = child_count;
+
+    for (uint32_t c = 0; c < child_count; ++c) build_node(pos, mass, leaf_size, first_child + c, depth + 1);
+
+    // Massa e centro di massa aggregati dai figli
+    FP total_mass = 0.0;
+    Vec<FP, Dim> weighted{};
+    for (uint32_t c = 0; c < child_count; ++c) {
+        const Node &child = arena[first_child + c];
+        total_mass += child.mass;
+        for (size_t d = 0; d < Dim; ++d) weighted[d] += child.mass * child.com[d];
+    }
+    Node &parent = arena[index];
+    parent.mass = total_mass;
+    for (size_t d = 0; d < Dim; ++d) parent.com[d] = total_mass > 0 ? weighted[d] / total_mass : node.center[d];
+
+    // Raggio: il minimo tra il limite dato dai figli e quello geometrico della cella
+    FP radius = 0.0;
+    for (uint32_t c = 0; c < child_count; ++c) {
+        const Node &child = arena[first_child + c];
+        FP dist_squared = 0.0;
+        for (size_t d = 0; d < Dim; ++d)
+            dist_squared += (child.com[d] - parent.com[d]) * (child.com[d] - parent.com[d]);
+        radius = std::max(radius, child.radius + std::sqrt(dist_squared));
+    }
+    FP corner_squared = 0.0;
+    for (size_t d = 0; d < Dim; ++d) {
+        const FP extent = std::abs(parent.com[d] - node.center[d]) + node.half_size;
+        corner_squared += extent * extent;
+    }
+    parent.radius = std::min(radius, std::sqrt(corner_squared));
+}
+
+#endif // TEAM_05_NBODY_ORTHANT_TREE_HPP
@@ -0,0 +1,105 @@
+#ifndef TEAM_05_NBODY_PAIR_KERNEL_HPP
+#define TEAM_05_NBODY_PAIR_KERNEL_HPP
+
+#include "interaction.hpp"
+#include "particle_system.hpp"
+#include <array>
+#include <string>
+#include <vector>
+
+// Insiemi di istruzioni vettoriali supportati dal kernel delle coppie
+enum class SimdIsa {
+    SCALAR,
+    AVX2,  // 4 double per registro
+    AVX512 // 8 double per registro
+};
+
+// Precisione del calcolo di 1/r^3
+enum class KernelPrecision {
+    FULL,    // sqrt e divisione IEEE
+    REDUCED, // rsqrt approssimata con due iterazioni di Newton-Raphson (opzionale)
+    MIXED    // Coppie in float (registri di larghezza doppia), somme delle forze in FP (opzionale)
+};
+
+// Restituisce l'insieme di istruzioni più ampio supportato dalla CPU. La variabile d'ambiente NBODY_SIMD
+// (scalar, avx2, avx512) permette di limitarlo, ad esempio per confronti e benchmark.
+SimdIsa detect_simd_isa();
+
+std::string to_string(SimdIsa isa);
+
+// Kernel delle interazioni gravitazionali a coppie, con implementazione vettoriale e legge di interazione
+// (interaction.hpp) scelte a runtime una volta per tutte: le righe sono istanziate per ogni legge
+template<std::floating_point FP, size_t Dim>
+class PairKernel {
+public:
+    // Interazioni della particella q con le sorgenti [begin, end): la forza su q è accumulata in force_q,
+    // la somma di G m_q m_k phi(r) in potential_q (l'energia potenziale delle coppie, cambiata di segno)
+    // e la reazione (terza legge di Newton) in reaction[d][k]. Le coppie coincidenti non contribuiscono.
+    using RowFunction = void (*)(const std::array<const FP *, Dim> &pos, const FP *mass, FP G,
+                                 const Interaction &interaction, size_t q, size_t begin, size_t end,
+                                 Vec<FP, Dim> &force_q, FP &potential_q, const std::array<FP *, Dim> &reaction);
+
+    // Come RowFunction, sulle copie in float di prepare e senza G: i risultati sono in unità scalate
+    using MixedRowFunction = void (*)(const std::array<const float *, Dim> &pos, const float *mass,
+                                      const Interaction &interaction, size_t q, size_t begin, size_t end,
+                                      Vec<FP, Dim> &force_q, FP &potential_q, const std::array<FP *, Dim> &reaction);
+
+    explicit PairKernel(SimdIsa isa = detect_simd_isa(), KernelPrecision precision = KernelPrecision::FULL,
+                        const Interaction &interaction = {});
+
+    // In precisione mista le righe leggono le copie in float delle particelle passate a prepare (pos e mass sono
+    // ignorati) e forze, reazioni ed energia vanno moltiplicate per force_unit() e potential_unit()
+    void row(const std::array<const FP *, Dim> &pos, const FP *mass, FP G, size_t q, size_t begin, size_t end,
+             Vec<FP, Dim> &force_q, FP &potential_q, const std::array<FP *, Dim> &reaction) const {
+        if (mixed_function) return mixed_function(mixed_pointers(), mixed_mass.data(), mixed_interaction, q, begin,
+                                                  end, force_q, potential_q, reaction);
+        function(pos, mass, G, interaction, q, begin, end, force_q, potential_q, reaction);
+    }
+
+    // Forza su q dalle sorgenti [begin, end), senza reazione: l'intervallo può contenere q stessa
+    void sum(const std::array<const FP *, Dim> &pos, const FP *mass, FP G, size_t q, size_t begin, size_t end,
+             Vec<FP, Dim> &force_q, FP &potential_q) const {
+        if (mixed_sum_function) return mixed_sum_function(mixed_pointers(), mixed_mass.data(), mixed_interaction, q,
+                                                          begin, end, force_q, potential_q, std::array<FP *, Dim>{});
+        sum_function(pos, mass, G, interaction, q, begin, end, force_q, potential_q, std::array<FP *, Dim>{});
+    }
+
+    // Solo in precisione mista: copia le particelle in float, con le posizioni relative al centro del box che le
+    // contiene e divise per la sua semiampiezza e le masse divise per la massima, così che i valori float siano
+    // di ordine 1 qualunque sia la scala del problema
+    void prepare(const ParticleSystem<FP, Dim> &particles, FP G);
+
+    FP force_unit() const { return unit_force; }
+
+    FP potential_unit() const { return unit_potential; }
+
+    SimdIsa isa() const { return selected_isa; }
+
+    KernelPrecision precision() const { return selected_precision; }
+
+    const Interaction &interaction_law() const { return interaction; }
+
+private:
+    Interaction interaction;
+    Interaction mixed_interaction; // La stessa legge nelle unità scalate di prepare
+    RowFunction function = nullptr;
+    RowFunction sum_function = nullptr;
+    MixedRowFunction mixed_function = nullptr;
+    MixedRowFunction mixed_sum_function = nullptr;
+    SimdIsa selected_isa;
+    KernelPrecision selected_precision;
+
+    std::vector<float> mixed_pos, mixed_mass; // Copie scalate, layout [dimensione][particella]
+    FP unit_force = 1, unit_potential = 1;
+
+    template<template<typename> class Law>
+    void select_rows(SimdIsa isa);
+
+    std::array<const float *, Dim> mixed_pointers() const {
+        std::array<const float *, Dim> result;
+        for (size_t d = 0; d < Dim; ++d) result[d] = mixed_pos.data() + d * mixed_mass.size();
+        return result;
+    }
+};
+
+#endif // TEAM_05_NBODY_PAIR_KERNEL_HPP
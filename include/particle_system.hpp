@@ -0,0 +1,165 @@
+#ifndef TEAM_05_NBODY_PARTICLE_SYSTEM_HPP
+#define TEAM_05_NBODY_PARTICLE_SYSTEM_HPP
+
+#include "aligned_allocator.hpp"
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+// Vista di una singola particella, usata solo per input/output
+template<std::floating_point FP>
+struct Particle {
+    FP mass; // Rimuovi 'const' per permettere il costruttore predefinito
+    std::vector<FP> pos;
+    std::vector<FP> vel;
+
+    // Costruttore predefinito
+    Particle() : mass(0.0), pos(), vel() {}
+
+    // Costruttore parametrizzato
+    Particle(FP m, const std::vector<FP> &p, const std::vector<FP> &v)
+            : mass(m), pos(p), vel(v) {
+        if (p.size() != v.size()) {
+            throw std::invalid_argument("Position and velocity vectors must have the same size");
+        }
+    }
+
+    friend std::ostream &operator<<(std::ostream &stream, const Particle &particle) {
+        stream << "m=" << particle.mass << " ";
+        for (size_t d = 0; d < particle.pos.size(); ++d) stream << "x" << d << "=" << particle.pos[d] << " ";
+        for (size_t d = 0; d < particle.vel.size(); ++d) stream << "v" << d << "=" << particle.vel[d] << " ";
+        return stream;
+    }
+};
+
+// Vettore di dimensione fissa, nota a tempo di compilazione: i cicli sulle dimensioni vengono srotolati
+template<std::floating_point FP, size_t Dim>
+using Vec = std::array<FP, Dim>;
+
+// Campo vettoriale in layout Structure-of-Arrays: una componente contigua e allineata per dimensione,
+// accessibile come field[d][i]
+template<std::floating_point FP, size_t Dim>
+class VectorField {
+public:
+    VectorField() = default;
+
+    explicit VectorField(size_t n) { resize(n); }
+
+    size_t size() const { return components[0].size(); }
+
+    static constexpr size_t dimensions() { return Dim; }
+
+    FP *operator[](size_t d) { return components[d].data(); }
+
+    const FP *operator[](size_t d) const { return components[d].data(); }
+
+    // Puntatori alle componenti, da passare ai kernel
+    std::array<FP *, Dim> pointers() {
+        std::array<FP *, Dim> result;
+        for (size_t d = 0; d < Dim; ++d) result[d] = components[d].data();
+        return result;
+    }
+
+    std::array<const FP *, Dim> pointers() const {
+        std::array<const FP *, Dim> result;
+        for (size_t d = 0; d < Dim; ++d) result[d] = components[d].data();
+        return result;
+    }
+
+    void resize(size_t n) {
+        for (auto &component: components) component.resize(n, 0.0);
+    }
+
+    void fill(FP value) {
+        for (auto &component: components) std::fill(component.begin(), component.end(), value);
+    }
+
+    void push_back(const std::vector<FP> &value) {
+        for (size_t d = 0; d < Dim; ++d) components[d].push_back(value[d]);
+    }
+
+    void push_back(const Vec<FP, Dim> &value) {
+        for (size_t d = 0; d < Dim; ++d) components[d].push_back(value[d]);
+    }
+
+    void clear() {
+        for (auto &component: components) component.clear();
+    }
+
+private:
+    std::array<aligned_vector<FP>, Dim> components;
+};
+
+// Insieme di particelle in layout Structure-of-Arrays: posizioni, velocità e masse sono array contigui,
+// in modo che il ciclo sulle coppie acceda alla memoria in modo sequenziale
+template<std::floating_point FP, size_t Dim>
+class ParticleSystem {
+public:
+    ParticleSystem() = default;
+
+    explicit ParticleSystem(size_t n)
+            : positions(n), velocities(n), masses(n, 0.0) {}
+
+    size_t size() const { return masses.size(); }
+
+    static constexpr size_t dimensions() { return Dim; }
+
+    VectorField<FP, Dim> &pos() { return positions; }
+
+    const VectorField<FP, Dim> &pos() const { return positions; }
+
+    VectorField<FP, Dim> &vel() { return velocities; }
+
+    const VectorField<FP, Dim> &vel() const { return velocities; }
+
+    FP *mass() { return masses.data(); }
+
+    const FP *mass() const { return masses.data(); }
+
+    void reserve(size_t n) {
+        masses.reserve(n);
+    }
+
+    // Aggiunge una particella, che deve avere la stessa dimensione del sistema
+    void push_back(const Particle<FP> &particle) {
+        if (particle.pos.size() != Dim) {
+            throw std::invalid_argument("Particle dimension does not match the problem dimension");
+        }
+        positions.push_back(particle.pos);
+        velocities.push_back(particle.vel);
+        masses.push_back(particle.mass);
+    }
+
+    // Aggiunge una particella senza passare dalla vista AoS (lettura in streaming del file di input)
+    void push_back(FP mass, const Vec<FP, Dim> &position, const Vec<FP, Dim> &velocity) {
+        positions.push_back(position);
+        velocities.push_back(velocity);
+        masses.push_back(mass);
+    }
+
+    // Vista AoS della particella i-esima
+    Particle<FP> get(size_t i) const {
+        std::vector<FP> p(Dim), v(Dim);
+        for (size_t d = 0; d < Dim; ++d) {
+            p[d] = positions[d][i];
+            v[d] = velocities[d][i];
+        }
+        return Particle<FP>(masses[i], p, v);
+    }
+
+    void clear() {
+        positions.clear();
+        velocities.clear();
+        masses.clear();
+    }
+
+private:
+    VectorField<FP, Dim> positions;
+    VectorField<FP, Dim> velocities;
+    aligned_vector<FP> masses;
+};
+
+#endif // TEAM_05_NBODY_PARTICLE_SYSTEM_HPP
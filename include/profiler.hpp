@@ -0,0 +1,202 @@
+#ifndef TEAM_05_NBODY_PROFILER_HPP
+#define TEAM_05_NBODY_PROFILER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Profilazione per fasi: timer con scope (annidabili) e contatori, raccolti da un'unica istanza globale.
+// Le macro NBODY_PROFILE_SCOPE e NBODY_PROFILE_COUNT sono vuote se il programma non è compilato con
+// NBODY_PROFILING (opzione CMake omonima): in quel caso gli argomenti non sono nemmeno valutati.
+// I timer vanno usati solo su fasi abbastanza lunghe (non dentro i cicli sulle particelle): ogni misura
+// acquisisce un mutex.
+class Profiler {
+public:
+    static Profiler &instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void begin(const char *name) { stack().push_back({name, Clock::now(), 0.0}); }
+
+    void end() {
+        auto &frames = stack();
+        const Frame frame = frames.back();
+        frames.pop_back();
+        const auto now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - frame.start).count();
+        if (!frames.empty()) frames.back().child += elapsed;
+
+        std::lock_guard lock(mutex);
+        const auto [it, inserted] = phase_index.try_emplace(frame.name, phases.size());
+        if (inserted) phases.push_back({frame.name});
+        Phase &phase = phases[it->second];
+        ++phase.calls;
+        phase.total += elapsed;
+        phase.self += elapsed - frame.child;
+        phase.max = std::max(phase.max, elapsed);
+        if (events.size() < max_events) {
+            events.push_back({frame.name, seconds_since_start(frame.start), elapsed, thread_index()});
+        } else {
+            ++dropped_events;
+        }
+    }
+
+    // Aggiunge amount al contatore; i conteggi sono separati per fase più interna attiva nel thread, così che la
+    // velocità sia riferita al tempo di quella fase
+    void count(const char *name, double amount) {
+        const auto &frames = stack();
+        const std::string phase = frames.empty() ? "" : frames.back().name;
+        std::lock_guard lock(mutex);
+        const auto [it, inserted] = counter_index.try_emplace(std::string(name) + '\0' + phase, counters.size());
+        if (inserted) counters.push_back({name, 0.0, phase});
+        counters[it->second].total += amount;
+    }
+
+    // Tabella riassuntiva: per fase chiamate, tempo totale (incluse le fasi annidate), tempo proprio e
+    // percentuale del tempo trascorso; per contatore totale e velocità
+    void report(std::ostream &stream) const {
+        std::lock_guard lock(mutex);
+        const double wall = seconds_since_start(Clock::now());
+        const auto flags = stream.flags();
+        const auto precision = stream.precision();
+
+        stream << "\nProfile (" << std::fixed << std::setprecision(3) << wall << " s elapsed)\n";
+        stream << std::left << std::setw(24) << "phase" << std::right << std::setw(10) << "calls" << std::setw(12)
+               << "total [s]" << std::setw(12) << "self [s]" << std::setw(12) << "mean [ms]" << std::setw(12)
+               << "max [ms]" << std::setw(9) << "self %" << "\n";
+        for (const auto &phase: phases) {
+            stream << std::left << std::setw(24) << phase.name << std::right << std::setw(10) << phase.calls
+                   << std::setw(12) << phase.total << std::setw(12) << phase.self << std::setw(12)
+                   << 1e3 * phase.total / double(phase.calls) << std::setw(12) << 1e3 * phase.max << std::setw(8)
+                   << std::setprecision(1) << (wall > 0 ? 100 * phase.self / wall : 0.0) << "%"
+                   << std::setprecision(3) << "\n";
+        }
+
+        if (!counters.empty()) {
+            stream << std::left << std::setw(24) << "counter" << std::right << std::setw(14) << "total"
+                   << std::setw(14) << "per second" << "  (time of)\n";
+            for (const auto &counter: counters) {
+                const Phase *phase = nullptr;
+                if (const auto it = phase_index.find(counter.phase); it != phase_index.end())
+                    phase = &phases[it->second];
+                const double seconds = phase ? phase->total : wall;
+                stream << std::left << std::setw(24) << counter.name << std::right << std::scientific
+                       << std::setw(14) << counter.total << std::setw(14)
+                       << (seconds > 0 ? counter.total / seconds : 0.0) << std::fixed << "  ("
+                       << (phase ? counter.phase : "run") << ")\n";
+            }
+        }
+        if (dropped_events > 0) stream << dropped_events << " trace events dropped (limit " << max_events << ")\n";
+
+        stream.flags(flags);
+        stream.precision(precision);
+    }
+
+    // Traccia in formato Chrome (chrome://tracing, Perfetto): un evento completo ("X") per ogni scope
+    void write_trace(const std::string &file_name, int process_id = 0) const {
+        std::ofstream file(file_name);
+        if (!file.is_open()) throw std::runtime_error("Error: Unable to open the trace file " + file_name);
+
+        std::lock_guard lock(mutex);
+        file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        for (size_t e = 0; e < events.size(); ++e) {
+            const Event &event = events[e];
+            file << (e > 0 ? ",\n" : "\n") << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"ts\":"
+                 << 1e6 * event.start << ",\"dur\":" << 1e6 * event.duration << ",\"pid\":" << process_id
+                 << ",\"tid\":" << event.thread << "}";
+        }
+        file << "\n]}\n";
+        if (!file) throw std::runtime_error("Error: Unable to write the trace file " + file_name);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Frame {
+        const char *name;
+        Clock::time_point start;
+        double child; // Tempo delle fasi annidate concluse
+    };
+
+    struct Phase {
+        std::string name;
+        uint64_t calls = 0;
+        double total = 0.0, self = 0.0, max = 0.0;
+    };
+
+    struct Counter {
+        std::string name;
+        double total = 0.0;
+        std::string phase;
+    };
+
+    struct Event {
+        const char *name;
+        double start, duration; // Secondi dalla creazione del profiler
+        uint32_t thread;
+    };
+
+    static constexpr size_t max_events = 1 << 20;
+
+    const Clock::time_point start = Clock::now();
+    mutable std::mutex mutex;
+    std::vector<Phase> phases; // Nell'ordine di prima comparsa
+    std::unordered_map<std::string, size_t> phase_index;
+    std::vector<Counter> counters;
+    std::unordered_map<std::string, size_t> counter_index; // Chiave: nome e fase separati da '\0'
+    std::vector<Event> events;
+    size_t dropped_events = 0;
+    std::unordered_map<std::thread::id, uint32_t> threads;
+
+    Profiler() = default;
+
+    static std::vector<Frame> &stack() {
+        thread_local std::vector<Frame> frames;
+        return frames;
+    }
+
+    double seconds_since_start(Clock::time_point time) const {
+        return std::chrono::duration<double>(time - start).count();
+    }
+
+    // Indice compatto del thread corrente (0 per il primo thread che chiude uno scope)
+    uint32_t thread_index() {
+        return threads.try_emplace(std::this_thread::get_id(), static_cast<uint32_t>(threads.size())).first->second;
+    }
+};
+
+// Misura il tempo dello scope in cui è dichiarato
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char *name) { Profiler::instance().begin(name); }
+
+    ~ScopedTimer() { Profiler::instance().end(); }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
+
+#define NBODY_PROFILE_CONCAT_(a, b) a##b
+#define NBODY_PROFILE_CONCAT(a, b) NBODY_PROFILE_CONCAT_(a, b)
+
+#ifdef NBODY_PROFILING
+#define NBODY_PROFILE_SCOPE(name) ScopedTimer NBODY_PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define NBODY_PROFILE_COUNT(name, amount) Profiler::instance().count(name, static_cast<double>(amount))
+#else
+#define NBODY_PROFILE_SCOPE(name) ((void) 0)
+#define NBODY_PROFILE_COUNT(name, amount) ((void) 0)
+#endif
+
+#endif // TEAM_05_NBODY_PROFILER_HPP
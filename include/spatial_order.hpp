@@ -0,0 +1,100 @@
+#ifndef TEAM_05_NBODY_SPATIAL_ORDER_HPP
+#define TEAM_05_NBODY_SPATIAL_ORDER_HPP
+
+#include "particle_system.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Riordinamento delle particelle lungo la curva di Morton (Z-order): le particelle vicine nello spazio diventano
+// vicine in memoria, a vantaggio delle visite degli alberi e dei blocchi del kernel diretto.
+// Le permutazioni sono espresse come order[i] = indice, prima del riordinamento, della particella che va in i.
+
+// Bit per coordinata della chiave a 64 bit
+template<size_t Dim>
+constexpr unsigned morton_bits = Dim == 1 ? 32 : 63 / Dim;
+
+// Intercala i bit delle coordinate intere, dal più significativo
+template<size_t Dim>
+uint64_t morton_key(const std::array<uint32_t, Dim> &cell) {
+    uint64_t key = 0;
+    for (unsigned b = morton_bits<Dim>; b-- > 0;)
+        for (size_t d = 0; d < Dim; ++d) key = (key << 1) | ((cell[d] >> b) & 1u);
+    return key;
+}
+
+// Ordine delle particelle lungo la curva di Morton nel box che le contiene. L'ordinamento è stabile: particelle
+// nella stessa cella della griglia mantengono l'ordine corrente. La normalizzazione è in double anche per FP = float:
+// in float 2^bits - 1 non è rappresentabile e il prodotto può arrotondare oltre l'ultima cella.
+template<std::floating_point FP, size_t Dim>
+void morton_order(const ParticleSystem<FP, Dim> &particles, std::vector<uint32_t> &order) {
+    const size_t n = particles.size();
+    order.resize(n);
+    if (n == 0) return;
+
+    constexpr uint64_t last_cell = (uint64_t(1) << morton_bits<Dim>) - 1;
+    Vec<double, Dim> low, scale;
+    for (size_t d = 0; d < Dim; ++d) {
+        const auto [min, max] = std::minmax_element(particles.pos()[d], particles.pos()[d] + n);
+        low[d] = *min;
+        // La coordinata massima va nell'ultima cella
+        scale[d] = *max > *min ? double(last_cell) / (double(*max) - double(*min)) : 0.0;
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        std::array<uint32_t, Dim> cell;
+        for (size_t d = 0; d < Dim; ++d) {
+            const double position = (double(particles.pos()[d][i]) - low[d]) * scale[d];
+            cell[d] = static_cast<uint32_t>(std::min<uint64_t>(static_cast<uint64_t>(position), last_cell));
+        }
+        keys[i] = {morton_key<Dim>(cell), static_cast<uint32_t>(i)};
+    }
+    std::sort(keys.begin(), keys.end()); // A parità di chiave decide l'indice: ordinamento stabile
+    for (size_t i = 0; i < n; ++i) order[i] = keys[i].second;
+}
+
+// Applica la permutazione a un array di n valori
+template<typename T>
+void permute(T *values, const std::vector<uint32_t> &order) {
+    std::vector<T> permuted(order.size());
+    for (size_t i = 0; i < order.size(); ++i) permuted[i] = values[order[i]];
+    std::copy(permuted.begin(), permuted.end(), values);
+}
+
+template<std::floating_point FP, size_t Dim>
+void permute(VectorField<FP, Dim> &field, const std::vector<uint32_t> &order) {
+    for (size_t d = 0; d < Dim; ++d) permute(field[d], order);
+}
+
+template<std::floating_point FP, size_t Dim>
+void permute(ParticleSystem<FP, Dim> &particles, const std::vector<uint32_t> &order) {
+    permute(particles.pos(), order);
+    permute(particles.vel(), order);
+    permute(particles.mass(), order);
+}
+
+// Permutazione inversa: permute(x, order) seguita da permute(x, inverse_permutation(order)) lascia x invariato
+inline std::vector<uint32_t> inverse_permutation(const std::vector<uint32_t> &order) {
+    std::vector<uint32_t> inverse(order.size());
+    for (size_t i = 0; i < order.size(); ++i) inverse[order[i]] = static_cast<uint32_t>(i);
+    return inverse;
+}
+
+// Operazione inversa di permute, in una copia: il valore in posizione i torna nella posizione order[i]
+template<std::floating_point FP, size_t Dim>
+void unpermute(const ParticleSystem<FP, Dim> &particles, const std::vector<uint32_t> &order,
+               ParticleSystem<FP, Dim> &original) {
+    const size_t n = particles.size();
+    if (original.size() != n) original = ParticleSystem<FP, Dim>(n);
+    for (size_t d = 0; d < Dim; ++d) {
+        for (size_t i = 0; i < n; ++i) {
+            original.pos()[d][order[i]] = particles.pos()[d][i];
+            original.vel()[d][order[i]] = particles.vel()[d][i];
+        }
+    }
+    for (size_t i = 0; i < n; ++i) original.mass()[order[i]] = particles.mass()[i];
+}
+
+#endif // TEAM_05_NBODY_SPATIAL_ORDER_HPP
@@ -0,0 +1,136 @@
+#ifndef TEAM_05_NBODY_TRAJECTORY_HPP
+#define TEAM_05_NBODY_TRAJECTORY_HPP
+
+#include "particle_system.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+// Formato degli snapshot
+enum class OutputFormat {
+    BINARY, // Un unico file di traiettoria binario (header + frame a passo fisso)
+    CSV     // Un file CSV per ogni snapshot
+};
+
+inline OutputFormat parse_output_format(const std::string &format) {
+    if (format == "binary") return OutputFormat::BINARY;
+    if (format == "csv") return OutputFormat::CSV;
+    throw std::invalid_argument("Unknown output format: " + format);
+}
+
+// Header del file di traiettoria (64 byte, little-endian). Seguono i frame, tutti di frame_bytes byte:
+// t, x[0][0..N), ..., x[Dim-1][0..N), v[0][0..N), ..., v[Dim-1][0..N), m[0..N)
+// Il file è scritto solo in coda: il numero di frame è (dimensione del file - header_bytes) / frame_bytes.
+struct TrajectoryHeader {
+    char magic[8];          // "NBODYTRJ"
+    uint32_t version;
+    uint32_t dimensions;
+    uint64_t num_particles;
+    uint32_t scalar_bytes;  // sizeof(FP)
+    uint32_t header_bytes;
+    uint64_t frame_bytes;
+    uint8_t reserved[24];
+};
+
+static_assert(sizeof(TrajectoryHeader) == 64, "The trajectory header must be 64 bytes long");
+
+template<std::floating_point FP, size_t Dim>
+TrajectoryHeader make_trajectory_header(size_t num_particles) {
+    TrajectoryHeader header{};
+    std::memcpy(header.magic, "NBODYTRJ", sizeof(header.magic));
+    header.version = 1;
+    header.dimensions = Dim;
+    header.num_particles = num_particles;
+    header.scalar_bytes = sizeof(FP);
+    header.header_bytes = sizeof(TrajectoryHeader);
+    header.frame_bytes = sizeof(FP) * (1 + (2 * Dim + 1) * num_particles);
+    return header;
+}
+
+// Verifica che il file esistente abbia l'header atteso e almeno frames frame completi
+inline void check_trajectory_prefix(const std::string &file_name, const TrajectoryHeader &expected, uint64_t frames) {
+    std::ifstream input(file_name, std::ios::binary);
+    TrajectoryHeader existing{};
+    if (!input.read(reinterpret_cast<char *>(&existing), sizeof(existing)) ||
+        std::memcmp(&existing, &expected, sizeof(expected)) != 0) {
+        throw std::runtime_error("Error: The trajectory " + file_name + " does not match the checkpoint");
+    }
+    if (std::filesystem::file_size(file_name) < expected.header_bytes + frames * expected.frame_bytes) {
+        throw std::runtime_error("Error: The trajectory " + file_name + " has fewer frames than the checkpoint");
+    }
+}
+
+// Scrittura della traiettoria binaria: i componenti SoA sono copiati direttamente, senza formattazione
+template<std::floating_point FP, size_t Dim>
+class TrajectoryWriter {
+public:
+    void open(const std::string &file_name, size_t num_particles) {
+        file.open(file_name, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error: Unable to open the output file!");
+        }
+        header = make_trajectory_header<FP, Dim>(num_particles);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        NBODY_PROFILE_COUNT("bytes written", sizeof(header));
+    }
+
+    // Riapre una traiettoria esistente conservandone solo i primi frames frame (ripresa da un checkpoint)
+    void resume(const std::string &file_name, size_t num_particles, uint64_t frames) {
+        header = make_trajectory_header<FP, Dim>(num_particles);
+        check_trajectory_prefix(file_name, header, frames);
+        std::filesystem::resize_file(file_name, header.header_bytes + frames * header.frame_bytes);
+        file.open(file_name, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error: Unable to open the output file!");
+        }
+    }
+
+    bool is_open() const { return file.is_open(); }
+
+    // Numero di valori FP di un frame
+    size_t frame_size() const { return header.frame_bytes / sizeof(FP); }
+
+    // Copia lo stato nel layout del frame (frame deve contenere frame_size() valori)
+    static void pack_frame(FP time, const ParticleSystem<FP, Dim> &particles, FP *frame) {
+        const size_t n = particles.size();
+        *frame++ = time;
+        for (size_t d = 0; d < Dim; ++d, frame += n) std::copy_n(particles.pos()[d], n, frame);
+        for (size_t d = 0; d < Dim; ++d, frame += n) std::copy_n(particles.vel()[d], n, frame);
+        std::copy_n(particles.mass(), n, frame);
+    }
+
+    void write_frame(FP time, const ParticleSystem<FP, Dim> &particles) {
+        const std::streamsize bytes = static_cast<std::streamsize>(particles.size() * sizeof(FP));
+        file.write(reinterpret_cast<const char *>(&time), sizeof(FP));
+        for (size_t d = 0; d < Dim; ++d) file.write(reinterpret_cast<const char *>(particles.pos()[d]), bytes);
+        for (size_t d = 0; d < Dim; ++d) file.write(reinterpret_cast<const char *>(particles.vel()[d]), bytes);
+        file.write(reinterpret_cast<const char *>(particles.mass()), bytes);
+        finish_frame();
+    }
+
+    // Scrive un frame già nel layout del file (vedi pack_frame)
+    void write_packed_frame(const FP *frame) {
+        file.write(reinterpret_cast<const char *>(frame), static_cast<std::streamsize>(header.frame_bytes));
+        finish_frame();
+    }
+
+    void close() { file.close(); }
+
+private:
+    std::ofstream file;
+    TrajectoryHeader header{};
+
+    void finish_frame() {
+        NBODY_PROFILE_COUNT("bytes written", header.frame_bytes);
+        // Ogni frame completo è subito leggibile (anche durante la simulazione)
+        file.flush();
+        if (!file) throw std::runtime_error("Error: Unable to write the trajectory frame!");
+    }
+};
+
+#endif // TEAM_05_NBODY_TRAJECTORY_HPP
@@ -0,0 +1,30 @@
+#ifndef TEAM_05_NBODY_VELOCITY_VERLET_INTEGRATOR_HPP
+#define TEAM_05_NBODY_VELOCITY_VERLET_INTEGRATOR_HPP
+
+#include "integrator.hpp"
+#include <utility>
+
+// Velocity-Verlet: x' = x + dt v + dt^2 / 2 a, v' = v + dt / 2 (a + a').
+// Equivalente al leapfrog kick-drift-kick in aritmetica esatta; conserva le forze dello step precedente.
+template<std::floating_point FP, size_t Dim>
+class VelocityVerletIntegrator : public Integrator<FP, Dim> {
+public:
+    void integrate(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                   const typename Integrator<FP, Dim>::ForceCallback &compute_forces, FP delta_t) override {
+        drift_accelerated(particles, forces, delta_t);
+        std::swap(forces, previous_forces);
+        forces.resize(particles.size());
+        compute_forces(particles, forces);
+        kick(particles, previous_forces, delta_t / 2);
+        kick(particles, forces, delta_t / 2);
+    }
+
+    std::string name() const override { return "velocity-verlet"; }
+
+    size_t force_evaluations() const override { return 1; }
+
+private:
+    VectorField<FP, Dim> previous_forces;
+};
+
+#endif // TEAM_05_NBODY_VELOCITY_VERLET_INTEGRATOR_HPP
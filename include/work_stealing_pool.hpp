@@ -0,0 +1,98 @@
+#ifndef TEAM_05_NBODY_WORK_STEALING_POOL_HPP
+#define TEAM_05_NBODY_WORK_STEALING_POOL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Esecuzione di un insieme fissato di lavori indipendenti su più thread. I lavori sono distribuiti a turno
+// nelle code dei thread, nell'ordine dato: ogni thread prende i propri dalla testa della coda e, quando la coda
+// è vuota, ruba dalla coda di un altro thread partendo dal fondo. Conviene quindi elencare prima i lavori più
+// costosi: ognuno inizia dai propri e i furti, alla fine, riguardano quelli brevi.
+// I lavori non ne generano altri, per cui un thread termina quando tutte le code sono vuote.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(size_t num_workers) : queues(num_workers) {
+        if (num_workers == 0) throw std::invalid_argument("The pool needs at least one thread");
+    }
+
+    size_t size() const { return queues.size(); }
+
+    // Chiama function(job, worker) per ogni job in jobs, con worker in [0, size()); il thread chiamante è il
+    // worker 0. La prima eccezione sollevata da un lavoro è rilanciata al termine, dopo che gli altri lavori
+    // già iniziati sono terminati (quelli non ancora iniziati sono scartati).
+    void run(const std::vector<size_t> &jobs, const std::function<void(size_t, size_t)> &function) {
+        for (size_t k = 0; k < jobs.size(); ++k) queues[k % queues.size()].jobs.push_back(jobs[k]);
+        failed = false;
+        error = nullptr;
+
+        std::vector<std::thread> threads;
+        for (size_t worker = 1; worker < queues.size(); ++worker) {
+            threads.emplace_back(&WorkStealingPool::work, this, worker, std::cref(function));
+        }
+        work(0, function);
+        for (auto &thread: threads) thread.join();
+
+        for (auto &queue: queues) queue.jobs.clear();
+        if (error) std::rethrow_exception(error);
+    }
+
+    // Lavori eseguiti da un thread diverso da quello a cui erano assegnati, in tutte le chiamate a run
+    uint64_t steal_count() const { return steals; }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    std::vector<Queue> queues;
+    std::atomic<uint64_t> steals = 0;
+    std::atomic<bool> failed = false;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    void work(size_t worker, const std::function<void(size_t, size_t)> &function) {
+        size_t job;
+        while (!failed && (pop(worker, job) || steal(worker, job))) {
+            try {
+                function(job, worker);
+            } catch (...) {
+                std::lock_guard lock(error_mutex);
+                if (!error) error = std::current_exception();
+                failed = true;
+            }
+        }
+    }
+
+    bool pop(size_t worker, size_t &job) {
+        Queue &queue = queues[worker];
+        std::lock_guard lock(queue.mutex);
+        if (queue.jobs.empty()) return false;
+        job = queue.jobs.front();
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    // Le vittime sono visitate a partire dal thread successivo, per distribuire i furti
+    bool steal(size_t thief, size_t &job) {
+        for (size_t k = 1; k < queues.size(); ++k) {
+            Queue &queue = queues[(thief + k) % queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (queue.jobs.empty()) continue;
+            job = queue.jobs.back();
+            queue.jobs.pop_back();
+            ++steals;
+            return true;
+        }
+        return false;
+    }
+};
+
+#endif // TEAM_05_NBODY_WORK_STEALING_POOL_HPP
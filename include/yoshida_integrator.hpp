@@ -0,0 +1,33 @@
+#ifndef TEAM_05_NBODY_YOSHIDA_INTEGRATOR_HPP
+#define TEAM_05_NBODY_YOSHIDA_INTEGRATOR_HPP
+
+#include "integrator.hpp"
+#include <cmath>
+
+// Integratore simplettico del quarto ordine di Yoshida (Forest-Ruth): composizione di tre passi leapfrog
+// kick-drift-kick di ampiezza w1 dt, w0 dt, w1 dt, con w1 = 1 / (2 - 2^(1/3)) e w0 = 1 - 2 w1 (negativo).
+// Tre valutazioni delle forze per step.
+template<std::floating_point FP, size_t Dim>
+class YoshidaIntegrator : public Integrator<FP, Dim> {
+public:
+    void integrate(ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces,
+                   const typename Integrator<FP, Dim>::ForceCallback &compute_forces, FP delta_t) override {
+        for (const FP weight: {w1, w0, w1}) {
+            const FP sub_step = weight * delta_t;
+            kick(particles, forces, sub_step / 2);
+            drift(particles, sub_step);
+            compute_forces(particles, forces);
+            kick(particles, forces, sub_step / 2);
+        }
+    }
+
+    std::string name() const override { return "yoshida4"; }
+
+    size_t force_evaluations() const override { return 3; }
+
+private:
+    static inline const FP w1 = 1 / (2 - std::cbrt(FP(2)));
+    static inline const FP w0 = 1 - 2 * w1;
+};
+
+#endif // TEAM_05_NBODY_YOSHIDA_INTEGRATOR_HPP
@@ -0,0 +1,52 @@
+import numpy as np
+
+# Must match TrajectoryHeader in include/trajectory.hpp
+HEADER_DTYPE = np.dtype([
+    ('magic', 'S8'),
+    ('version', '<u4'),
+    ('dimensions', '<u4'),
+    ('num_particles', '<u8'),
+    ('scalar_bytes', '<u4'),
+    ('header_bytes', '<u4'),
+    ('frame_bytes', '<u8'),
+    ('reserved', 'V24'),
+])
+MAGIC = b'NBODYTRJ'
+
+
+def read_trajectory(filename):
+    """Memory-map a binary trajectory file, returning its header and the array of frames.
+
+    Every frame is a record with fields 't', 'x' (dimensions x particles), 'v' (dimensions x particles) and 'm'.
+    Only complete frames are mapped, so a trajectory can be read while the simulation is still running."""
+    header = np.fromfile(filename, dtype=HEADER_DTYPE, count=1)
+    if len(header) != 1 or header['magic'][0] != MAGIC:
+        raise ValueError(f"'{filename}' is not an N-Body trajectory file.")
+    header = {name: int(header[name][0]) for name in ('version', 'dimensions', 'num_particles', 'scalar_bytes',
+                                                  'header_bytes', 'frame_bytes')}
+
+    scalar = np.dtype(f"<f{header['scalar_bytes']}")
+    dim, n = int(header['dimensions']), int(header['num_particles'])
+    frame_dtype = np.dtype([('t', scalar), ('x', scalar, (dim, n)), ('v', scalar, (dim, n)), ('m', scalar, (n,))])
+    if frame_dtype.itemsize != header['frame_bytes']:
+        raise ValueError(f"'{filename}': unexpected frame size {header['frame_bytes']}.")
+
+    file_size = np.memmap(filename, dtype=np.uint8, mode='r').size
+    num_frames = (file_size - header['header_bytes']) // frame_dtype.itemsize
+    if num_frames == 0:
+        return header, np.empty(0, dtype=frame_dtype)
+    frames = np.memmap(filename, dtype=frame_dtype, mode='r', offset=header['header_bytes'],
+                       shape=(num_frames,))
+    return header, frames
+
+
+def frame_columns(frame):
+    """Views of a frame with the same column names as the CSV snapshots (t, x0.., v0.., m)."""
+    n = frame['m'].shape[0]
+    columns = {'t': np.full(n, frame['t'])}
+    for d in range(frame['x'].shape[0]):
+        columns[f"x{d}"] = frame['x'][d]
+    for d in range(frame['v'].shape[0]):
+        columns[f"v{d}"] = frame['v'][d]
+    columns['m'] = frame['m']
+    return columns
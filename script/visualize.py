@@ -1,11 +1,13 @@
 import glob
 import logging
+import os
 import matplotlib.pyplot as plt
-import pandas as pd
 import numpy as np
 
 from matplotlib.animation import FuncAnimation
 
+from trajectory import read_trajectory, frame_columns
+
 log = logging.getLogger("visualize")
 logging.basicConfig(format='%(asctime)s [%(levelname)s] :: %(message)s', datefmt='%m/%d/%Y %I:%M:%S %p',
                     level=logging.INFO)
@@ -13,6 +15,8 @@ logging.basicConfig(format='%(asctime)s [%(levelname)s] :: %(message)s', datefmt
 
 def load_snapshots(nbody_filenames):
     """Load the snapshots, provided source filenames."""
+    import pandas as pd
+
     log.info(f"Loading N-Body snapshots...")
     snapshots = []
     for filename in nbody_filenames:
@@ -22,6 +26,15 @@ def load_snapshots(nbody_filenames):
     return snapshots
 
 
+def load_trajectory(trajectory_filename):
+    """Load the snapshots of a binary trajectory file, memory-mapped with numpy."""
+    log.info(f"Loading N-Body trajectory...")
+    header, frames = read_trajectory(trajectory_filename)
+    snapshots = [frame_columns(frame) for frame in frames]
+    log.info(f"N-Body trajectory loaded: {len(snapshots)} frames of {header['num_particles']} particles.")
+    return snapshots
+
+
 def animation_2d(snapshots, animation_interval, trajectory_length=20):
     """Visualize the N-Body evolution animation in a 2D space, provided the source snapshots."""
     log.info(f"Visualizing the N-Body snapshots...")
@@ -53,7 +66,7 @@ def animation_2d(snapshots, animation_interval, trajectory_length=20):
     ax.set_ylim([y_min - 1, y_max + 1])
 
     # Initializing lists to keep track of previous positions (trajectories)
-    trajectories = {i: ([], []) for i in range(len(snapshots[0]))}
+    trajectories = {i: ([], []) for i in range(len(snapshots[0]['x0']))}
 
     # Setting-up the scatter with initial snapshot state
     scatter = ax.scatter(snapshots[0]['x0'], snapshots[0]['x1'],
@@ -89,7 +102,7 @@ def animation_2d(snapshots, animation_interval, trajectory_length=20):
                     linewidth=0.5)
 
         # Updating scatter plot
-        scatter.set_offsets([(row.x0, row.x1) for row in snapshot.itertuples(index=False)])
+        scatter.set_offsets(np.column_stack((x, y)))
         # Setting point sizes based on mass
         scatter.set_sizes(mass * 10)
         # Mapping velocity to color
@@ -139,7 +152,7 @@ def animation_3d(snapshots, animation_interval, trajectory_length=20):
     ax.set_zlim([z_min, z_max])
 
     # Initializing lists to keep track of previous positions (trajectories)
-    trajectories = {i: ([], [], []) for i in range(len(snapshots[0]))}
+    trajectories = {i: ([], [], []) for i in range(len(snapshots[0]['x0']))}
 
     # Setting-up the scatter with initial snapshot state
     scatter = ax.scatter(snapshots[0]['x0'], snapshots[0]['x1'], snapshots[0]['x2'],
@@ -193,14 +206,23 @@ def animation_3d(snapshots, animation_interval, trajectory_length=20):
     plt.show()
 
 
-def main(input_dir, input_filename_prefix, animation_interval):
-    nbody_filenames = sorted(glob.glob(f"{input_dir}/{input_filename_prefix}*.csv"))
-    if not nbody_filenames:
-        log.info("No CSV file found in the specified directory.")
+def main(input_dir, input_filename_prefix, animation_interval, trajectory_filename=None):
+    if trajectory_filename is None and os.path.exists(f"{input_dir}/nbody.traj"):
+        trajectory_filename = f"{input_dir}/nbody.traj"
+
+    if trajectory_filename is not None:
+        snapshots = load_trajectory(trajectory_filename)
+    else:
+        nbody_filenames = sorted(glob.glob(f"{input_dir}/{input_filename_prefix}*.csv"))
+        if not nbody_filenames:
+            log.info("No trajectory or CSV file found in the specified directory.")
+            return
+        snapshots = load_snapshots(nbody_filenames)
+    if not snapshots:
+        log.info("The trajectory contains no frame.")
         return
 
-    snapshots = load_snapshots(nbody_filenames)
-    if 'x2' in snapshots[0].columns:
+    if 'x2' in snapshots[0]:
         log.info("Interpreting the given files as a 3D problem.")
         animation_3d(snapshots, animation_interval)
     else:
@@ -210,9 +232,9 @@ def main(input_dir, input_filename_prefix, animation_interval):
 
 if __name__ == "__main__":
     import argparse
-    import os
 
-    parser = argparse.ArgumentParser(description="Plot the N-Body time evolution, given some source .CSV files.")
+    parser = argparse.ArgumentParser(description="Plot the N-Body time evolution, given a binary trajectory file or "
+                                                 "some source .CSV files.")
     parser.add_argument(
         "-i",
         "--input",
@@ -225,6 +247,12 @@ if __name__ == "__main__":
         help="the prefix of the input files",
         default="nbody-"
     )
+    parser.add_argument(
+        "-t",
+        "--trajectory",
+        help="the binary trajectory file (default: <input>/nbody.traj, if present)",
+        default=None
+    )
     parser.add_argument(
         "-a",
         "--animation-interval",
@@ -239,4 +267,4 @@ if __name__ == "__main__":
 
     log.info(f"-- Input directory:\t{args.input}")
     log.info(f"-- Input prefix:\t{args.input_prefix}")
-    main(args.input, args.input_prefix, args.animation_interval)
+    main(args.input, args.input_prefix, args.animation_interval, args.trajectory)
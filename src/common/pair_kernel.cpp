@@ -0,0 +1,518 @@
+#include "pair_kernel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define NBODY_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// Versione scalare, usata anche per il resto dei cicli vettoriali e per le leggi non vettoriali.
+// Con Symmetric = false la reazione non è accumulata (somma delle forze su q soltanto).
+template<template<typename> class Law, std::floating_point FP, size_t Dim, bool Symmetric = true>
+static void row_scalar(const std::array<const FP *, Dim> &pos, const FP *mass, FP G, const Interaction &interaction,
+                       size_t q, size_t begin, size_t end, Vec<FP, Dim> &force_q, FP &potential_q,
+                       const std::array<FP *, Dim> &reaction) {
+    const Law<FP> law(interaction);
+    const FP g_mass_q = G * mass[q];
+
+    for (size_t k = begin; k < end; ++k) {
+        Vec<FP, Dim> diff;
+        FP dist_squared = 0.0;
+        for (size_t d = 0; d < Dim; ++d) {
+            diff[d] = pos[d][q] - pos[d][k];
+            dist_squared += diff[d] * diff[d];
+        }
+        if (dist_squared == 0)
+            continue;
+
+        FP factor, pair_potential;
+        law(g_mass_q * mass[k], dist_squared, factor, pair_potential);
+        potential_q += pair_potential; // G m_q m_k / r per la legge di Newton
+
+        for (size_t d = 0; d < Dim; ++d) {
+            force_q[d] -= factor * diff[d];
+            if constexpr (Symmetric) reaction[d][k] += factor * diff[d];
+        }
+    }
+}
+
+// Precisione mista: la forza su q è accumulata in float su blocchi di mixed_block sorgenti, poi sommata in FP;
+// la reazione è accumulata direttamente in FP. Versione scalare, usata anche per il resto dei cicli vettoriali.
+static constexpr size_t mixed_block = 256;
+
+template<template<typename> class Law, std::floating_point FP, size_t Dim, bool Symmetric = true>
+static void mixed_row_scalar(const std::array<const float *, Dim> &pos, const float *mass,
+                             const Interaction &interaction, size_t q, size_t begin, size_t end,
+                             Vec<FP, Dim> &force_q, FP &potential_q, const std::array<FP *, Dim> &reaction) {
+    const Law<float> law(interaction);
+    for (size_t block = begin; block < end; block += mixed_block) {
+        Vec<float, Dim> block_force{};
+        float block_potential = 0.0f;
+        for (size_t k = block; k < std::min(end, block + mixed_block); ++k) {
+            Vec<float, Dim> diff;
+            float dist_squared = 0.0f;
+            for (size_t d = 0; d < Dim; ++d) {
+                diff[d] = pos[d][q] - pos[d][k];
+                dist_squared += diff[d] * diff[d];
+            }
+            if (dist_squared == 0)
+                continue;
+
+            float factor, pair_potential;
+            law(mass[q] * mass[k], dist_squared, factor, pair_potential);
+            block_potential += pair_potential;
+            for (size_t d = 0; d < Dim; ++d) {
+                block_force[d] -= factor * diff[d];
+                if constexpr (Symmetric) reaction[d][k] += factor * diff[d];
+            }
+        }
+        for (size_t d = 0; d < Dim; ++d) force_q[d] += block_force[d];
+        potential_q += block_potential;
+    }
+}
+
+#ifdef NBODY_X86_SIMD
+
+// I kernel vettoriali sono istanziati per le leggi con la forma newtoniana in r^2 + epsilon^2 (vectorized):
+// r^2 è sostituito da softened, mentre le coppie coincidenti si riconoscono ancora da r^2 = 0.
+// Per la legge di Newton l'addizione è omessa, così che i risultati non cambino.
+template<template<typename> class Law>
+static constexpr bool adds_softening = !std::is_same_v<Law<double>, NewtonianLaw<double>>;
+
+// Stima di 1/sqrt(x) per x double normale, con rsqrt in singola precisione. x = m 2^(2h), con m in [1, 4) sempre
+// rappresentabile in float, quindi rsqrt(x) = rsqrt(m) 2^-h: la conversione diretta di x in float darebbe 0 o
+// infinito per r^2 fuori dall'intervallo dei float (r oltre ~1.8e19 o sotto ~1e-19).
+__attribute__((target("avx2,fma")))
+static inline __m256d rsqrt_estimate_avx2(__m256d x) {
+    const __m256i bits = _mm256_castpd_si256(x);
+    const __m256i exponent = _mm256_srli_epi64(bits, 52); // Con bias 1023, x >= 0
+    // Esponente di m: 1023 se quello di x è dispari (esponente senza bias pari), altrimenti 1024
+    const __m256i mantissa_exponent = _mm256_add_epi64(_mm256_set1_epi64x(1023),
+                                                       _mm256_andnot_si256(exponent, _mm256_set1_epi64x(1)));
+    const __m256d mantissa = _mm256_castsi256_pd(_mm256_or_si256(
+            _mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFF)), _mm256_slli_epi64(mantissa_exponent, 52)));
+    // 2^-h, con esponente 1023 - h = (2046 + esponente di m - esponente di x) / 2
+    const __m256i scale_exponent = _mm256_srli_epi64(
+            _mm256_sub_epi64(_mm256_add_epi64(_mm256_set1_epi64x(2046), mantissa_exponent), exponent), 1);
+    const __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(scale_exponent, 52));
+    return _mm256_mul_pd(_mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(mantissa))), scale);
+}
+
+// AVX2 + FMA: 4 sorgenti per iterazione
+template<template<typename> class Law, size_t Dim, bool Reduced, bool Symmetric = true>
+__attribute__((target("avx2,fma")))
+static void row_avx2(const std::array<const double *, Dim> &pos, const double *mass, double G,
+                     const Interaction &interaction, size_t q, size_t begin, size_t end, Vec<double, Dim> &force_q,
+                     double &potential_q, const std::array<double *, Dim> &reaction) {
+    const Law<double> law(interaction);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d g_mass_q = _mm256_set1_pd(G * mass[q]);
+    const __m256d epsilon_squared = _mm256_set1_pd(law.softening_squared());
+
+    __m256d pos_q[Dim], acc[Dim], potential = zero;
+    for (size_t d = 0; d < Dim; ++d) {
+        pos_q[d] = _mm256_set1_pd(pos[d][q]);
+        acc[d] = zero;
+    }
+
+    size_t k = begin;
+    for (; k + 4 <= end; k += 4) {
+        __m256d diff[Dim];
+        __m256d dist_squared = zero;
+        for (size_t d = 0; d < Dim; ++d) {
+            diff[d] = _mm256_sub_pd(pos_q[d], _mm256_loadu_pd(pos[d] + k));
+            dist_squared = _mm256_fmadd_pd(diff[d], diff[d], dist_squared);
+        }
+        __m256d softened = dist_squared;
+        if constexpr (adds_softening<Law>) softened = _mm256_add_pd(dist_squared, epsilon_squared);
+
+        __m256d inv_dist_cubed;
+        if constexpr (Reduced) {
+            // Stima a 12 bit in singola precisione, raffinata con due iterazioni di Newton: y <- y (3 - r^2 y^2) / 2
+            __m256d y = rsqrt_estimate_avx2(softened);
+            const __m256d half_r2 = _mm256_mul_pd(_mm256_set1_pd(0.5), softened);
+            const __m256d three_halves = _mm256_set1_pd(1.5);
+            for (int iter = 0; iter < 2; ++iter)
+                y = _mm256_mul_pd(y, _mm256_fnmadd_pd(half_r2, _mm256_mul_pd(y, y), three_halves));
+            inv_dist_cubed = _mm256_mul_pd(y, _mm256_mul_pd(y, y));
+        } else {
+            const __m256d dist = _mm256_sqrt_pd(softened);
+            inv_dist_cubed = _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_mul_pd(softened, dist));
+        }
+
+        __m256d factor = _mm256_mul_pd(_mm256_mul_pd(g_mass_q, _mm256_loadu_pd(mass + k)), inv_dist_cubed);
+        // Le coppie coincidenti non contribuiscono
+        factor = _mm256_and_pd(factor, _mm256_cmp_pd(dist_squared, zero, _CMP_NEQ_OQ));
+        potential = _mm256_fmadd_pd(factor, softened, potential);
+
+        for (size_t d = 0; d < Dim; ++d) {
+            const __m256d force = _mm256_mul_pd(factor, diff[d]);
+            acc[d] = _mm256_sub_pd(acc[d], force);
+            if constexpr (Symmetric)
+                _mm256_storeu_pd(reaction[d] + k, _mm256_add_pd(_mm256_loadu_pd(reaction[d] + k), force));
+        }
+    }
+
+    for (size_t d = 0; d < Dim; ++d) {
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc[d]);
+        force_q[d] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, potential);
+    potential_q += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+    row_scalar<Law, double, Dim, Symmetric>(pos, mass, G, interaction, q, k, end, force_q, potential_q, reaction);
+}
+
+// AVX-512: 8 sorgenti per iterazione
+// (le varianti maskz con maschera piena evitano i falsi warning di GCC 12 sulle intrinsics non mascherate)
+template<template<typename> class Law, size_t Dim, bool Reduced, bool Symmetric = true>
+__attribute__((target("avx512f")))
+static void row_avx512(const std::array<const double *, Dim> &pos, const double *mass, double G,
+                       const Interaction &interaction, size_t q, size_t begin, size_t end, Vec<double, Dim> &force_q,
+                       double &potential_q, const std::array<double *, Dim> &reaction) {
+    const Law<double> law(interaction);
+    const __m512d zero = _mm512_setzero_pd();
+    const __mmask8 all = 0xFF;
+    const __m512d g_mass_q = _mm512_set1_pd(G * mass[q]);
+    const __m512d epsilon_squared = _mm512_set1_pd(law.softening_squared());
+
+    __m512d pos_q[Dim], acc[Dim], potential = zero;
+    for (size_t d = 0; d < Dim; ++d) {
+        pos_q[d] = _mm512_set1_pd(pos[d][q]);
+        acc[d] = zero;
+    }
+
+    size_t k = begin;
+    for (; k + 8 <= end; k += 8) {
+        __m512d diff[Dim];
+        __m512d dist_squared = zero;
+        for (size_t d = 0; d < Dim; ++d) {
+            diff[d] = _mm512_sub_pd(pos_q[d], _mm512_loadu_pd(pos[d] + k));
+            dist_squared = _mm512_fmadd_pd(diff[d], diff[d], dist_squared);
+        }
+        __m512d softened = dist_squared;
+        if constexpr (adds_softening<Law>) softened = _mm512_add_pd(dist_squared, epsilon_squared);
+
+        __m512d inv_dist_cubed;
+        if constexpr (Reduced) {
+            // Stima a 14 bit, raffinata con due iterazioni di Newton: y <- y (3 - r^2 y^2) / 2
+            __m512d y = _mm512_maskz_rsqrt14_pd(all, softened);
+            const __m512d half_r2 = _mm512_mul_pd(_mm512_set1_pd(0.5), softened);
+            const __m512d three_halves = _mm512_set1_pd(1.5);
+            for (int iter = 0; iter < 2; ++iter)
+                y = _mm512_mul_pd(y, _mm512_fnmadd_pd(half_r2, _mm512_mul_pd(y, y), three_halves));
+            inv_dist_cubed = _mm512_mul_pd(y, _mm512_mul_pd(y, y));
+        } else {
+            const __m512d dist = _mm512_maskz_sqrt_pd(all, softened);
+            inv_dist_cubed = _mm512_div_pd(_mm512_set1_pd(1.0), _mm512_mul_pd(softened, dist));
+        }
+
+        // Le coppie coincidenti non contribuiscono
+        const __mmask8 distinct = _mm512_cmp_pd_mask(dist_squared, zero, _CMP_NEQ_OQ);
+        const __m512d factor = _mm512_maskz_mul_pd(distinct, _mm512_mul_pd(g_mass_q, _mm512_loadu_pd(mass + k)),
+                                                   inv_dist_cubed);
+        potential = _mm512_fmadd_pd(factor, softened, potential);
+
+        for (size_t d = 0; d < Dim; ++d) {
+            const __m512d force = _mm512_mul_pd(factor, diff[d]);
+            acc[d] = _mm512_sub_pd(acc[d], force);
+            if constexpr (Symmetric)
+                _mm512_storeu_pd(reaction[d] + k, _mm512_add_pd(_mm512_loadu_pd(reaction[d] + k), force));
+        }
+    }
+
+    for (size_t d = 0; d < Dim; ++d) {
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, acc[d]);
+        force_q[d] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, potential);
+    potential_q += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+
+    row_scalar<Law, double, Dim, Symmetric>(pos, mass, G, interaction, q, k, end, force_q, potential_q, reaction);
+}
+
+// Precisione mista con AVX2 + FMA: 8 sorgenti per iterazione, accumulatori della forza su q in double
+template<template<typename> class Law, size_t Dim, bool Symmetric = true>
+__attribute__((target("avx2,fma")))
+static void mixed_row_avx2(const std::array<const float *, Dim> &pos, const float *mass,
+                           const Interaction &interaction, size_t q, size_t begin, size_t end,
+                           Vec<double, Dim> &force_q, double &potential_q, const std::array<double *, Dim> &reaction) {
+    const Law<float> law(interaction);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 mass_q = _mm256_set1_ps(mass[q]);
+    const __m256 epsilon_squared = _mm256_set1_ps(law.softening_squared());
+
+    __m256 pos_q[Dim];
+    __m256d acc[Dim], potential = _mm256_setzero_pd();
+    for (size_t d = 0; d < Dim; ++d) {
+        pos_q[d] = _mm256_set1_ps(pos[d][q]);
+        acc[d] = _mm256_setzero_pd();
+    }
+
+    size_t k = begin;
+    while (k + 8 <= end) {
+        const size_t block_end = std::min(end, k + mixed_block);
+        __m256 block_force[Dim], block_potential = zero;
+        for (size_t d = 0; d < Dim; ++d) block_force[d] = zero;
+
+        for (; k + 8 <= block_end; k += 8) {
+            __m256 diff[Dim];
+            __m256 dist_squared = zero;
+            for (size_t d = 0; d < Dim; ++d) {
+                diff[d] = _mm256_sub_ps(pos_q[d], _mm256_loadu_ps(pos[d] + k));
+                dist_squared = _mm256_fmadd_ps(diff[d], diff[d], dist_squared);
+            }
+            __m256 softened = dist_squared;
+            if constexpr (adds_softening<Law>) softened = _mm256_add_ps(dist_squared, epsilon_squared);
+            const __m256 inv_dist_cubed = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                                        _mm256_mul_ps(softened, _mm256_sqrt_ps(softened)));
+
+            __m256 factor = _mm256_mul_ps(_mm256_mul_ps(mass_q, _mm256_loadu_ps(mass + k)), inv_dist_cubed);
+            // Le coppie coincidenti non contribuiscono
+            factor = _mm256_and_ps(factor, _mm256_cmp_ps(dist_squared, zero, _CMP_NEQ_OQ));
+            block_potential = _mm256_fmadd_ps(factor, softened, block_potential);
+
+            for (size_t d = 0; d < Dim; ++d) {
+                const __m256 force = _mm256_mul_ps(factor, diff[d]);
+                block_force[d] = _mm256_sub_ps(block_force[d], force);
+                if constexpr (Symmetric) {
+                    const __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(force));
+                    const __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(force, 1));
+                    _mm256_storeu_pd(reaction[d] + k, _mm256_add_pd(_mm256_loadu_pd(reaction[d] + k), low));
+                    _mm256_storeu_pd(reaction[d] + k + 4, _mm256_add_pd(_mm256_loadu_pd(reaction[d] + k + 4), high));
+                }
+            }
+        }
+
+        // Fine del blocco: le somme parziali in float passano agli accumulatori in double
+        for (size_t d = 0; d < Dim; ++d) {
+            acc[d] = _mm256_add_pd(acc[d], _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(block_force[d])),
+                                                         _mm256_cvtps_pd(_mm256_extractf128_ps(block_force[d], 1))));
+        }
+        potential = _mm256_add_pd(potential, _mm256_add_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(block_potential)),
+                                                           _mm256_cvtps_pd(_mm256_extractf128_ps(block_potential, 1))));
+    }
+
+    for (size_t d = 0; d < Dim; ++d) {
+        alignas(32) double lanes[4];
+        _mm256_store_pd(lanes, acc[d]);
+        force_q[d] += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, potential);
+    potential_q += (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+
+    mixed_row_scalar<Law, double, Dim, Symmetric>(pos, mass, interaction, q, k, end, force_q, potential_q, reaction);
+}
+
+// Metà bassa e alta di un registro float, convertite in double. In GCC 12 le estrazioni a 256 bit danno un
+// falso warning sul registro sorgente non inizializzato, che non ha una variante maskz: è disattivato qui.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+static inline __m512d low(__m512 value) {
+    return _mm512_cvtps_pd(_mm512_castps512_ps256(value));
+}
+
+__attribute__((target("avx512f")))
+static inline __m512d high(__m512 value) {
+    return _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(value), 1)));
+}
+
+// Precisione mista con AVX-512: 16 sorgenti per iterazione, accumulatori della forza su q in double
+template<template<typename> class Law, size_t Dim, bool Symmetric = true>
+__attribute__((target("avx512f")))
+static void mixed_row_avx512(const std::array<const float *, Dim> &pos, const float *mass,
+                             const Interaction &interaction, size_t q, size_t begin, size_t end,
+                             Vec<double, Dim> &force_q, double &potential_q,
+                             const std::array<double *, Dim> &reaction) {
+    const Law<float> law(interaction);
+    const __m512 zero = _mm512_setzero_ps();
+    const __mmask16 all = 0xFFFF;
+    const __m512 mass_q = _mm512_set1_ps(mass[q]);
+    const __m512 epsilon_squared = _mm512_set1_ps(law.softening_squared());
+
+    __m512 pos_q[Dim];
+    __m512d acc[Dim], potential = _mm512_setzero_pd();
+    for (size_t d = 0; d < Dim; ++d) {
+        pos_q[d] = _mm512_set1_ps(pos[d][q]);
+        acc[d] = _mm512_setzero_pd();
+    }
+
+    size_t k = begin;
+    while (k + 16 <= end) {
+        const size_t block_end = std::min(end, k + mixed_block);
+        __m512 block_force[Dim], block_potential = zero;
+        for (size_t d = 0; d < Dim; ++d) block_force[d] = zero;
+
+        for (; k + 16 <= block_end; k += 16) {
+            __m512 diff[Dim];
+            __m512 dist_squared = zero;
+            for (size_t d = 0; d < Dim; ++d) {
+                diff[d] = _mm512_sub_ps(pos_q[d], _mm512_loadu_ps(pos[d] + k));
+                dist_squared = _mm512_fmadd_ps(diff[d], diff[d], dist_squared);
+            }
+            __m512 softened = dist_squared;
+            if constexpr (adds_softening<Law>) softened = _mm512_add_ps(dist_squared, epsilon_squared);
+            const __m512 dist = _mm512_maskz_sqrt_ps(all, softened);
+            const __m512 inv_dist_cubed = _mm512_div_ps(_mm512_set1_ps(1.0f), _mm512_mul_ps(softened, dist));
+
+            // Le coppie coincidenti non contribuiscono
+            const __mmask16 distinct = _mm512_cmp_ps_mask(dist_squared, zero, _CMP_NEQ_OQ);
+            const __m512 factor = _mm512_maskz_mul_ps(distinct, _mm512_mul_ps(mass_q, _mm512_loadu_ps(mass + k)),
+                                                      inv_dist_cubed);
+            block_potential = _mm512_fmadd_ps(factor, softened, block_potential);
+
+            for (size_t d = 0; d < Dim; ++d) {
+                const __m512 force = _mm512_mul_ps(factor, diff[d]);
+                block_force[d] = _mm512_sub_ps(block_force[d], force);
+                if constexpr (Symmetric) {
+                    _mm512_storeu_pd(reaction[d] + k, _mm512_add_pd(_mm512_loadu_pd(reaction[d] + k), low(force)));
+                    _mm512_storeu_pd(reaction[d] + k + 8,
+                                     _mm512_add_pd(_mm512_loadu_pd(reaction[d] + k + 8), high(force)));
+                }
+            }
+        }
+
+        // Fine del blocco: le somme parziali in float passano agli accumulatori in double
+        for (size_t d = 0; d < Dim; ++d)
+            acc[d] = _mm512_add_pd(acc[d], _mm512_add_pd(low(block_force[d]), high(block_force[d])));
+        potential = _mm512_add_pd(potential, _mm512_add_pd(low(block_potential), high(block_potential)));
+    }
+
+    for (size_t d = 0; d < Dim; ++d) {
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, acc[d]);
+        force_q[d] += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, potential);
+    potential_q += ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+
+    mixed_row_scalar<Law, double, Dim, Symmetric>(pos, mass, interaction, q, k, end, force_q, potential_q, reaction);
+}
+#pragma GCC diagnostic pop
+
+#endif // NBODY_X86_SIMD
+
+SimdIsa detect_simd_isa() {
+    SimdIsa supported = SimdIsa::SCALAR;
+#ifdef NBODY_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) supported = SimdIsa::AVX512;
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) supported = SimdIsa::AVX2;
+#endif
+
+    // Eventuale limite richiesto dall'utente
+    if (const char *requested = std::getenv("NBODY_SIMD")) {
+        const std::string value(requested);
+        if (value == "scalar") return SimdIsa::SCALAR;
+        if (value == "avx2" && supported != SimdIsa::SCALAR) return SimdIsa::AVX2;
+    }
+    return supported;
+}
+
+std::string to_string(SimdIsa isa) {
+    switch (isa) {
+        case SimdIsa::AVX2: return "avx2";
+        case SimdIsa::AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+PairKernel<FP, Dim>::PairKernel(SimdIsa isa, KernelPrecision precision, const Interaction &interaction)
+        : interaction(interaction), mixed_interaction(interaction), selected_isa(SimdIsa::SCALAR),
+          selected_precision(precision) {
+    visit_interaction_law(interaction, [&]<template<typename> class Law>(InteractionLawTag<Law>) {
+        select_rows<Law>(isa);
+    });
+}
+
+// Le righe sono istanziate per la legge di interazione: la scelta avviene qui, non nel ciclo sulle coppie
+template<std::floating_point FP, size_t Dim>
+template<template<typename> class Law>
+void PairKernel<FP, Dim>::select_rows(SimdIsa isa) {
+    function = row_scalar<Law, FP, Dim>;
+    sum_function = row_scalar<Law, FP, Dim, false>;
+    if (selected_precision == KernelPrecision::MIXED) {
+        mixed_function = mixed_row_scalar<Law, FP, Dim>;
+        mixed_sum_function = mixed_row_scalar<Law, FP, Dim, false>;
+#ifdef NBODY_X86_SIMD
+        if constexpr (std::is_same_v<FP, double> && Law<float>::vectorized) {
+            if (isa == SimdIsa::AVX512) {
+                mixed_function = mixed_row_avx512<Law, Dim>;
+                mixed_sum_function = mixed_row_avx512<Law, Dim, false>;
+                selected_isa = isa;
+            } else if (isa == SimdIsa::AVX2) {
+                mixed_function = mixed_row_avx2<Law, Dim>;
+                mixed_sum_function = mixed_row_avx2<Law, Dim, false>;
+                selected_isa = isa;
+            }
+        }
+#endif
+        return;
+    }
+#ifdef NBODY_X86_SIMD
+    if constexpr (std::is_same_v<FP, double> && Law<double>::vectorized) {
+        const bool reduced = selected_precision == KernelPrecision::REDUCED;
+        if (isa == SimdIsa::AVX512) {
+            function = reduced ? row_avx512<Law, Dim, true> : row_avx512<Law, Dim, false>;
+            sum_function = reduced ? row_avx512<Law, Dim, true, false> : row_avx512<Law, Dim, false, false>;
+            selected_isa = isa;
+        } else if (isa == SimdIsa::AVX2) {
+            function = reduced ? row_avx2<Law, Dim, true> : row_avx2<Law, Dim, false>;
+            sum_function = reduced ? row_avx2<Law, Dim, true, false> : row_avx2<Law, Dim, false, false>;
+            selected_isa = isa;
+        }
+    }
+#endif
+}
+
+template<std::floating_point FP, size_t Dim>
+void PairKernel<FP, Dim>::prepare(const ParticleSystem<FP, Dim> &particles, FP G) {
+    if (selected_precision != KernelPrecision::MIXED) return;
+    const size_t n = particles.size();
+    mixed_pos.resize(Dim * n);
+    mixed_mass.resize(n);
+    if (n == 0) return;
+
+    // Box che contiene le particelle: centro (origine locale) e semiampiezza massima (unità di lunghezza)
+    Vec<FP, Dim> center;
+    FP length = 0;
+    for (size_t d = 0; d < Dim; ++d) {
+        const auto [low, high] = std::minmax_element(particles.pos()[d], particles.pos()[d] + n);
+        center[d] = (*low + *high) / 2;
+        length = std::max(length, (*high - *low) / 2);
+    }
+    FP mass = *std::max_element(particles.mass(), particles.mass() + n);
+    if (length == 0) length = 1;
+    if (mass == 0) mass = 1;
+
+    for (size_t d = 0; d < Dim; ++d) {
+        const FP *pos = particles.pos()[d];
+        for (size_t i = 0; i < n; ++i) mixed_pos[d * n + i] = static_cast<float>((pos[i] - center[d]) / length);
+    }
+    for (size_t i = 0; i < n; ++i) mixed_mass[i] = static_cast<float>(particles.mass()[i] / mass);
+
+    // F = G m_q m_k (x_q - x_k) / r^3 e U = G m_q m_k / r, con m = mass m' e x = center + length x'.
+    // Le leggi con softening hanno la stessa dipendenza dalle unità se anche epsilon è diviso per length.
+    mixed_interaction = interaction.scaled(1 / static_cast<double>(length));
+    unit_potential = G * mass * mass / length;
+    unit_force = unit_potential / length;
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class PairKernel<double, 1>;
+template class PairKernel<double, 2>;
+template class PairKernel<double, 3>;
+template class PairKernel<float, 1>;
+template class PairKernel<float, 2>;
+template class PairKernel<float, 3>;
@@ -1,24 +1,247 @@
-#include "n_body_2D.hpp"
-#include "../third_party/json.hpp"
+#include "n_body.hpp"
+#include "input_reader.hpp"
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 
+#ifdef NBODY_MODEL_MPI
+#include "n_body_mpi.hpp"
+#endif
+
+// Crea il solver per la dimensione richiesta (istanze supportate: 1, 2, 3)
+template<template<std::floating_point, size_t> class Solver, std::floating_point FP, typename... Args>
+static std::unique_ptr<AbstractNbody<FP>> make_nbody(size_t dimensions, Args &&...args)
+{
+    switch (dimensions)
+    {
+    case 1: return std::make_unique<Solver<FP, 1>>(std::forward<Args>(args)...);
+    case 2: return std::make_unique<Solver<FP, 2>>(std::forward<Args>(args)...);
+    case 3: return std::make_unique<Solver<FP, 3>>(std::forward<Args>(args)...);
+    }
+    throw std::invalid_argument("Unsupported problem dimension: " + std::to_string(dimensions));
+}
+
+// Verifica che la dimensione eventualmente indicata da riga di comando sia quella del file di input
+static void check_dimensions(int argc, char *argv[], size_t dimensions)
+{
+    if (argc > 2 && std::stoul(argv[2]) != dimensions)
+        throw std::invalid_argument("Dimension mismatch: the input file describes a " + std::to_string(dimensions)
+                                    + "D problem");
+}
+
+// Opzioni "--nome valore" da riga di comando: il checkpoint da cui riprendere e le chiavi che sostituiscono
+// quelle del file di input
+struct CommandLine
+{
+    std::string checkpoint_file;
+    nlohmann::json overrides = nlohmann::json::object();
+};
+
+// Opzione, chiave corrispondente del file di input e tipo del valore (intero o stringa)
+struct ConfigOption
+{
+    const char *name;
+    const char *key;
+    bool integer;
+};
+
+static constexpr ConfigOption config_options[] = {
+    {"--precision", "precision", false},
+    {"--engine", "force_engine", false},
+    {"--integrator", "integrator", false},
+    {"--threads", "threads", true},
+    {"--output-format", "output_format", false},
+    {"--output-every", "output_every", true},
+    {"--verbosity", "verbosity", false},
+};
+
+static const char options_usage[] = " [--precision float|double] [--engine direct|barnes-hut|fmm]"
+                                    " [--integrator <name>] [--threads <n>] [--output-format binary|csv]"
+                                    " [--output-every <k>] [--verbosity quiet|normal|verbose]"
+                                    " [--restart <checkpoint>]";
+
+// Estrae le opzioni, in qualunque posizione, lasciando in argv i soli argomenti posizionali
+static CommandLine take_options(int &argc, char *argv[])
+{
+    CommandLine command_line;
+    int positional = 1;
+    for (int a = 1; a < argc; ++a)
+    {
+        const std::string option = argv[a];
+        if (option.rfind("--", 0) != 0)
+        {
+            argv[positional++] = argv[a];
+            continue;
+        }
+        if (a + 1 >= argc)
+            throw std::invalid_argument("Missing value for " + option);
+        const std::string value = argv[++a];
+
+        if (option == "--restart")
+        {
+            command_line.checkpoint_file = value;
+            continue;
+        }
+        const auto match = std::find_if(std::begin(config_options), std::end(config_options),
+                                        [&](const ConfigOption &known) { return option == known.name; });
+        if (match == std::end(config_options))
+            throw std::invalid_argument("Unknown option: " + option);
+        if (!match->integer)
+            command_line.overrides[match->key] = value;
+        else if (!value.empty() && value.find_first_not_of("0123456789") == std::string::npos)
+            command_line.overrides[match->key] = std::stoul(value);
+        else
+            throw std::invalid_argument("Invalid value for " + option + ": " + value);
+    }
+    argc = positional;
+    return command_line;
+}
+
+// Dimensione del problema e precisione dei calcoli: l'opzione --precision, altrimenti la chiave "precision" del
+// file di input se precede "particles" (default double)
+static InputLayout problem_layout(const std::string &input_file, const CommandLine &command_line)
+{
+    InputLayout layout = read_input_layout(input_file);
+    if (command_line.overrides.contains("precision"))
+        layout.precision = command_line.overrides["precision"];
+    if (layout.precision.empty())
+        layout.precision = "double";
+    if (layout.precision != "double" && layout.precision != "float")
+        throw std::invalid_argument("Unknown precision: " + layout.precision);
+    return layout;
+}
+
+// Setup, eventuale ripresa da un checkpoint e solve
+template<std::floating_point FP>
+static void run(AbstractNbody<FP> &nbody, const std::string &input_file, const CommandLine &command_line)
+{
+    nbody.set_overrides(command_line.overrides);
+    nbody.setup(input_file);
+    if (!command_line.checkpoint_file.empty())
+        nbody.restart(command_line.checkpoint_file);
+    nbody.solve();
+}
+
+#ifdef NBODY_PROFILING
+// Stampa la tabella dei tempi per fase; se NBODY_TRACE è definita scrive anche la traccia in formato Chrome
+// (con più processi MPI, un file per rank con suffisso ".<rank>")
+static void report_profile(int rank = 0, int size = 1)
+{
+    if (rank == 0)
+        Profiler::instance().report(std::cout);
+    if (const char *trace = std::getenv("NBODY_TRACE"))
+        Profiler::instance().write_trace(size > 1 ? std::string(trace) + "." + std::to_string(rank) : trace, rank);
+}
+#endif
+
+#ifdef NBODY_MODEL_MPI
+
 int main(int argc, char *argv[])
 {
+    // Il thread di scrittura della traiettoria (output per-rank) non esegue chiamate MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
 
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    CommandLine command_line;
+    try
+    {
+        command_line = take_options(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        if (rank == 0)
+            std::cerr << e.what() << std::endl;
+        argc = 0;
+    }
     if (argc < 2)
     {
-        std::cerr << "Usage: " << argv[0] << " <input_file> <dimensions>" << std::endl;
+        if (rank == 0)
+            std::cerr << "Usage: " << argv[0] << " <input_file> [dimensions] [allgather|ring] [collective|per-rank]"
+                      << options_usage << std::endl;
+        MPI_Finalize();
         return EXIT_FAILURE;
     }
 
     std::string input_file = argv[1];
+    ExchangeMode exchange_mode = (argc > 3 && std::string(argv[3]) == "ring") ? ExchangeMode::RING
+                                                                               : ExchangeMode::ALLGATHER;
+    OutputMode output_mode = (argc > 4 && std::string(argv[4]) == "per-rank") ? OutputMode::PER_RANK
+                                                                               : OutputMode::COLLECTIVE;
 
-    // Crea il sistema NBody2D
-    NBody2D<double> nbody;
+    try
+    {
+        // Crea il sistema distribuito, nella dimensione e precisione del problema
+        const InputLayout layout = problem_layout(input_file, command_line);
+        check_dimensions(argc, argv, layout.dimensions);
+        if (layout.precision == "float")
+            run(*make_nbody<NBodyMPI, float>(layout.dimensions, MPI_COMM_WORLD, exchange_mode, output_mode),
+                input_file, command_line);
+        else
+            run(*make_nbody<NBodyMPI, double>(layout.dimensions, MPI_COMM_WORLD, exchange_mode, output_mode),
+                input_file, command_line);
 
-    // Setup, solve e output
-    nbody.setup(input_file);
-    nbody.solve();
+#ifdef NBODY_PROFILING
+        int size;
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+        report_profile(rank, size);
+#endif
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "[rank " << rank << "] " << e.what() << std::endl;
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+    CommandLine command_line;
+    try
+    {
+        command_line = take_options(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << e.what() << std::endl;
+        argc = 0;
+    }
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input_file> [dimensions]" << options_usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::string input_file = argv[1];
+
+    try
+    {
+        // Crea il sistema NBody nella dimensione e precisione del problema
+        const InputLayout layout = problem_layout(input_file, command_line);
+        check_dimensions(argc, argv, layout.dimensions);
+        if (layout.precision == "float")
+            run(*make_nbody<NBody, float>(layout.dimensions), input_file, command_line);
+        else
+            run(*make_nbody<NBody, double>(layout.dimensions), input_file, command_line);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+#ifdef NBODY_PROFILING
+    report_profile();
+#endif
 
     return EXIT_SUCCESS;
 }
+
+#endif
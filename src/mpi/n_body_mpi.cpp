@@ -0,0 +1,558 @@
+#include "n_body_mpi.hpp"
+#include "input_reader.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+// Tipo MPI corrispondente al tipo floating point
+template<std::floating_point FP>
+static MPI_Datatype mpi_type() {
+    if constexpr (std::is_same_v<FP, float>) return MPI_FLOAT;
+    else if constexpr (std::is_same_v<FP, double>) return MPI_DOUBLE;
+    else return MPI_LONG_DOUBLE;
+}
+
+template<std::floating_point FP, size_t Dim>
+NBodyMPI<FP, Dim>::NBodyMPI(MPI_Comm communicator, ExchangeMode exchange_mode, OutputMode output_mode,
+                            std::unique_ptr<Integrator<FP, Dim>> integrator)
+        : AbstractNbody<FP>(0, 0.0), comm(communicator), integrator(std::move(integrator)),
+          exchange_mode(exchange_mode), output_mode(output_mode) {
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+}
+
+// Metodo setup: ogni rank legge il file in parallelo e conserva solo il proprio blocco di particelle
+// (con un file binario di particelle, legge solo le pagine del proprio blocco)
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::setup(std::string file_name) {
+    NBODY_PROFILE_SCOPE("setup");
+    // Decomposizione a blocchi bilanciata: i primi N % size rank ricevono una particella in più
+    const auto decompose = [this](size_t n) {
+        counts.assign(size, 0);
+        offsets.assign(size, 0);
+        for (int r = 0; r < size; ++r) {
+            counts[r] = static_cast<int>(n / size + (static_cast<size_t>(r) < n % size ? 1 : 0));
+            if (r > 0) offsets[r] = offsets[r - 1] + counts[r - 1];
+        }
+        local_n = counts[rank];
+        offset = offsets[rank];
+        return std::pair<size_t, size_t>(offset, offset + local_n);
+    };
+    nlohmann::json data = read_input(file_name, particles, decompose);
+    data.update(this->overrides);
+    this->check_precision(data);
+
+    this->N = data["N"];
+    this->delta_t = data["delta_t"];
+    this->t_max = data["max_time"];
+
+    // Inizializza forze e buffer di scambio
+    forces.resize(local_n);
+
+    if (exchange_mode == ExchangeMode::ALLGATHER) {
+        // Le masse non cambiano: vengono raccolte una sola volta
+        global_pos.resize(this->N * Dim);
+        global_mass.resize(this->N);
+        MPI_Allgatherv(particles.mass(), static_cast<int>(local_n), mpi_type<FP>(),
+                       global_mass.data(), counts.data(), offsets.data(), mpi_type<FP>(), comm);
+    } else {
+        const size_t max_count = *std::max_element(counts.begin(), counts.end());
+        ring_buffer.resize(max_count * (Dim + 1));
+    }
+
+    if (data.contains("integrator")) integrator = make_integrator<FP, Dim>(data["integrator"]);
+    if (data.value("block_timesteps", false)) {
+        throw std::invalid_argument("Block timesteps are not supported by the MPI implementation");
+    }
+    if (data.value("force_engine", "direct") != "direct") {
+        throw std::invalid_argument("The MPI implementation only supports the direct force engine");
+    }
+    for (const char *key: {"reduced_precision", "mixed_precision", "precision_report"}) {
+        if (data.value(key, false)) {
+            throw std::invalid_argument(std::string("The MPI implementation does not support ") + key +
+                                        ": its direct kernel is scalar, in full precision");
+        }
+    }
+    interaction = Interaction(parse_softening(data.value("softening", "none")), data.value("softening_length", 0.0));
+    integrator->set_max_reduction([this](FP value) {
+        MPI_Allreduce(MPI_IN_PLACE, &value, 1, mpi_type<FP>(), MPI_MAX, comm);
+        return value;
+    });
+
+    // Formato e frequenza degli snapshot
+    this->output_format = parse_output_format(data.value("output_format", "binary"));
+    this->output_every = data.value("output_every", size_t(1));
+    if (this->output_every == 0) throw std::invalid_argument("output_every must be positive");
+    this->output_queue_depth = data.value("output_queue_depth", size_t(2));
+
+    // Frequenza e formato della diagnostica, scritta dal rank 0
+    this->diagnostics_every = data.value("diagnostics_every", size_t(1));
+    this->diagnostics_format = parse_diagnostics_format(data.value("diagnostics_format", "csv"));
+
+    // Checkpoint periodici, scritti dal rank 0
+    this->checkpoint_every = data.value("checkpoint_every", size_t(0));
+    this->checkpoint_filename = data.value("checkpoint_file", std::string(DEF_CHECKPOINT_FILENAME));
+    this->start_step = 0;
+    resume_frames.reset();
+
+    // Messaggi durante la simulazione, stampati dal rank 0 ("threads" non ha effetto: un thread per rank;
+    // "reorder_every" neppure: ogni rank possiede un blocco contiguo di indici del file di input)
+    this->verbosity = parse_verbosity(data.value("verbosity", "normal"));
+
+    // Popola il vettore this->time con gli step temporali
+    this->time.clear();
+    FP current_time = 0.0;
+    while (current_time <= this->t_max) {
+        this->time.push_back(current_time);
+        current_time += this->delta_t;
+    }
+}
+
+// Metodo solve
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::solve() {
+    if (rank == 0 && this->logs(Verbosity::NORMAL)) {
+        std::cout << "Starting simulation with " << this->N << " particles on " << size << " ranks ("
+                  << (exchange_mode == ExchangeMode::RING ? "ring" : "allgather") << " exchange) and delta_t = "
+                  << this->delta_t << " (" << 8 * sizeof(FP) << "-bit), " << configuration() << "\n";
+        if (this->checkpoint_every > 0) {
+            std::cout << "Writing a checkpoint every " << this->checkpoint_every << " step(s) to '"
+                      << this->checkpoint_filename << "'\n";
+        }
+    }
+
+    // Forze iniziali (dopo restart, quelle del checkpoint). Il calcolo delle forze è collettivo e usa sempre il
+    // blocco locale e il suo campo di forze, che sono gli argomenti passati dall'integratore.
+    if (this->start_step == 0) compute_forces();
+    const auto force_callback = [this](const ParticleSystem<FP, Dim> &, VectorField<FP, Dim> &) {
+        compute_forces();
+    };
+
+    if (this->diagnostics_every > 0) {
+        const std::string diagnostics_file = this->diagnostics_filename +
+                                             diagnostics_extension(this->diagnostics_format);
+        if (rank == 0) {
+            if (this->start_step == 0) diagnostics.open(diagnostics_file, this->diagnostics_format);
+            if (this->logs(Verbosity::NORMAL)) {
+                std::cout << "Writing diagnostics every " << this->diagnostics_every << " step(s) to '"
+                          << diagnostics_file << "'\n";
+            }
+        }
+        if (this->start_step == 0) write_diagnostics(0);
+    }
+
+    for (size_t step = this->start_step; step < this->time.size(); ++step) {
+        if (rank == 0 && this->logs(Verbosity::VERBOSE)) {
+            std::cout << "Step " << step + 1 << "/" << this->time.size() << "...\n";
+        }
+
+        {
+            NBODY_PROFILE_SCOPE("integrate");
+            integrator->integrate(particles, forces, force_callback, this->delta_t); // Integra il blocco locale
+        }
+
+        const bool last_step = step + 1 == this->time.size();
+        if (this->diagnostics_every > 0 && ((step + 1) % this->diagnostics_every == 0 || last_step)) {
+            write_diagnostics(step + 1);
+        }
+
+        if (step % this->output_every == 0) output(step);
+
+        if (this->checkpoint_every > 0 && ((step + 1) % this->checkpoint_every == 0 || last_step)) {
+            write_checkpoint(step + 1);
+        }
+    }
+    close_trajectory();
+    if (diagnostics.is_open()) {
+        diagnostics.close();
+        if (this->logs(Verbosity::NORMAL)) {
+            std::cout << "Energy: initial = " << diagnostics.first().total_energy() << ", final = "
+                      << diagnostics.latest().total_energy() << ", max relative change = "
+                      << diagnostics.max_relative_energy_change() << "\n";
+        }
+    }
+}
+
+// Somme locali ridotte sul rank 0; l'energia potenziale è quella dell'ultimo calcolo delle forze
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::write_diagnostics(size_t step) {
+    NBODY_PROFILE_SCOPE("diagnostics");
+    auto values = measure_diagnostics(particles, local_potential).values();
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : values.data(), values.data(), static_cast<int>(values.size()),
+               mpi_type<FP>(), MPI_SUM, 0, comm);
+    if (rank == 0) {
+        diagnostics.write(step, FP(step) * this->delta_t, Diagnostics<FP, Dim>::from_values(values));
+    }
+}
+
+// I frame in scrittura sono completati prima del checkpoint, che ne registra il numero
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::write_checkpoint(size_t step) {
+    NBODY_PROFILE_SCOPE("checkpoint");
+    if (trajectory_file != MPI_FILE_NULL) {
+        MPI_Waitall(static_cast<int>(frame_requests.size()), frame_requests.data(), MPI_STATUSES_IGNORE);
+    }
+    if (rank_trajectory.is_open()) rank_trajectory.flush();
+
+    ParticleSystem<FP, Dim> all_particles(rank == 0 ? this->N : 0);
+    VectorField<FP, Dim> all_forces(rank == 0 ? this->N : 0);
+    const auto gather = [this](const FP *local, FP *global) {
+        MPI_Gatherv(local, static_cast<int>(local_n), mpi_type<FP>(), global, counts.data(), offsets.data(),
+                    mpi_type<FP>(), 0, comm);
+    };
+    for (size_t d = 0; d < Dim; ++d) gather(particles.pos()[d], all_particles.pos()[d]);
+    for (size_t d = 0; d < Dim; ++d) gather(particles.vel()[d], all_particles.vel()[d]);
+    gather(particles.mass(), all_particles.mass());
+    for (size_t d = 0; d < Dim; ++d) gather(forces[d], all_forces[d]);
+    if (rank != 0) return;
+
+    CheckpointWriter checkpoint(this->checkpoint_filename);
+    write_particle_state(checkpoint, all_particles, all_forces);
+    checkpoint.write_string(configuration());
+    checkpoint.write_value(uint8_t(0)); // Nessuno stato dei passi a blocchi
+    write_particle_order(checkpoint, {}); // Le particelle restano nell'ordine del file di input
+    diagnostics.save_state(checkpoint);
+    checkpoint.commit(make_checkpoint_header<FP, Dim>(this->N, step, FP(step) * this->delta_t, this->delta_t));
+}
+
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::restart(const std::string &checkpoint_file) {
+    NBODY_PROFILE_SCOPE("restart");
+    ParticleSystem<FP, Dim> all_particles;
+    VectorField<FP, Dim> all_forces;
+    uint64_t step = 0;
+
+    // Gli errori del rank 0 terminano tutti i processi (MPI_Abort in main)
+    if (rank == 0) {
+        CheckpointReader checkpoint(checkpoint_file);
+        checkpoint.check<FP, Dim>(this->delta_t);
+        const CheckpointHeader &header = checkpoint.header();
+        if (header.num_particles != this->N) {
+            throw std::invalid_argument("The checkpoint " + checkpoint_file + " has " +
+                                        std::to_string(header.num_particles) + " particles");
+        }
+        if (header.step >= this->time.size()) {
+            throw std::invalid_argument("The checkpoint " + checkpoint_file + " is at the end of the simulation: "
+                                        "increase max_time to continue it");
+        }
+
+        read_particle_state(checkpoint, all_particles, all_forces);
+        const std::string checkpoint_configuration = checkpoint.read_string();
+        if (checkpoint_configuration != configuration()) {
+            std::cerr << "Warning: the checkpoint was written with " << checkpoint_configuration
+                      << ": the continuation will not be bit-identical\n";
+        }
+        if (checkpoint.read_value<uint8_t>() != 0) {
+            throw std::invalid_argument("The checkpoint " + checkpoint_file + " was written with block timesteps");
+        }
+        // Un checkpoint con le particelle riordinate torna all'ordine del file di input
+        const std::vector<uint32_t> ids = read_particle_order(checkpoint);
+        if (!ids.empty()) {
+            const std::vector<uint32_t> inverse = inverse_permutation(ids);
+            permute(all_particles, inverse);
+            permute(all_forces, inverse);
+        }
+        if (this->diagnostics_every > 0) {
+            diagnostics.resume(this->diagnostics_filename + diagnostics_extension(this->diagnostics_format),
+                               this->diagnostics_format, checkpoint);
+        }
+        step = header.step;
+        if (this->logs(Verbosity::NORMAL)) {
+            std::cout << "Resuming from step " << step << " (t = " << header.time << ") of '" << checkpoint_file
+                      << "'\n";
+        }
+    }
+    MPI_Bcast(&step, 1, MPI_UINT64_T, 0, comm);
+
+    const auto scatter = [this](const FP *global, FP *local) {
+        MPI_Scatterv(global, counts.data(), offsets.data(), mpi_type<FP>(), local, static_cast<int>(local_n),
+                     mpi_type<FP>(), 0, comm);
+    };
+    for (size_t d = 0; d < Dim; ++d) scatter(all_particles.pos()[d], particles.pos()[d]);
+    for (size_t d = 0; d < Dim; ++d) scatter(all_particles.vel()[d], particles.vel()[d]);
+    scatter(all_particles.mass(), particles.mass());
+    for (size_t d = 0; d < Dim; ++d) scatter(all_forces[d], forces[d]);
+
+    this->start_step = step;
+    if (this->output_format == OutputFormat::BINARY) {
+        resume_frames = (step + this->output_every - 1) / this->output_every;
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::compute_forces() {
+    NBODY_PROFILE_SCOPE("force");
+    forces.fill(0.0);
+    local_potential = 0.0;
+
+    if (exchange_mode == ExchangeMode::ALLGATHER) compute_forces_allgather();
+    else compute_forces_ring();
+}
+
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::compute_forces_allgather() {
+    // Le componenti SoA sono già contigue: una raccolta per dimensione
+    {
+        NBODY_PROFILE_SCOPE("exchange");
+        for (size_t d = 0; d < Dim; ++d) {
+            MPI_Allgatherv(particles.pos()[d], static_cast<int>(local_n), mpi_type<FP>(),
+                           global_pos.data() + d * this->N, counts.data(), offsets.data(), mpi_type<FP>(), comm);
+        }
+    }
+
+    accumulate_forces(global_pos.data(), this->N, global_mass.data(), this->N, 0);
+}
+
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::compute_forces_ring() {
+    const size_t max_count = ring_buffer.size() / (Dim + 1);
+    FP *buffer_pos = ring_buffer.data();
+    FP *buffer_mass = ring_buffer.data() + max_count * Dim;
+
+    // Il primo blocco in transito è quello locale
+    for (size_t d = 0; d < Dim; ++d) {
+        std::copy(particles.pos()[d], particles.pos()[d] + local_n, buffer_pos + d * max_count);
+    }
+    std::copy(particles.mass(), particles.mass() + local_n, buffer_mass);
+
+    const int next = (rank + 1) % size;
+    const int prev = (rank - 1 + size) % size;
+    int owner = rank;
+
+    for (int s = 0; s < size; ++s) {
+        accumulate_forces(buffer_pos, max_count, buffer_mass, counts[owner], offsets[owner]);
+
+        if (s < size - 1) {
+            NBODY_PROFILE_SCOPE("exchange");
+            MPI_Sendrecv_replace(ring_buffer.data(), static_cast<int>(ring_buffer.size()), mpi_type<FP>(),
+                                 next, 0, prev, 0, comm, MPI_STATUS_IGNORE);
+            owner = (owner - 1 + size) % size;
+        }
+    }
+}
+
+// Le coppie di particelle locali sono calcolate una volta sola, con la reazione (terza legge di Newton);
+// le sorgenti degli altri rank agiscono solo sulle particelle locali, come il rank proprietario fa con le nostre
+template<std::floating_point FP, size_t Dim>
+template<typename Law>
+void NBodyMPI<FP, Dim>::accumulate_forces(const Law &law, const FP *src_pos, size_t src_stride, const FP *src_mass,
+                                          size_t src_count, size_t src_offset) {
+    const auto &pos = particles.pos();
+    const FP *mass = particles.mass();
+    const FP G = AbstractNbody<FP>::G;
+
+    // Il blocco sorgente contiene il blocco locale (blocco iniziale dell'anello, o tutte le particelle con
+    // ALLGATHER), oppure è disgiunto da esso
+    const bool contains_local = src_offset <= offset && offset + local_n <= src_offset + src_count;
+    const size_t local_begin = contains_local ? offset - src_offset : src_count;
+    const size_t local_end = contains_local ? local_begin + local_n : src_count;
+    NBODY_PROFILE_COUNT("pair interactions", local_n * (src_count - (local_end - local_begin)) +
+                                             (local_end - local_begin) * (local_n - 1) / 2);
+    const std::array<std::pair<size_t, size_t>, 2> remote{{{0, local_begin}, {local_end, src_count}}};
+
+    for (size_t i = 0; i < local_n; ++i) {
+        // Sorgenti remote: [0, local_begin) e [local_end, src_count)
+        for (const auto &[begin, end]: remote) {
+            for (size_t j = begin; j < end; ++j) {
+                Vec<FP, Dim> diff;
+                FP dist_squared = 0.0;
+                for (size_t d = 0; d < Dim; ++d) {
+                    diff[d] = src_pos[d * src_stride + j] - pos[d][i];
+                    dist_squared += diff[d] * diff[d];
+                }
+                if (dist_squared == 0)
+                    continue;
+                FP factor, pair_potential;
+                law(G * mass[i] * src_mass[j], dist_squared, factor, pair_potential);
+                local_potential -= pair_potential / 2; // Ogni coppia è vista da entrambe le particelle
+
+                for (size_t d = 0; d < Dim; ++d) {
+                    forces[d][i] += factor * diff[d];
+                }
+            }
+        }
+        if (!contains_local) continue;
+
+        // Particelle locali k > i, lette direttamente dal blocco locale
+        for (size_t k = i + 1; k < local_n; ++k) {
+            Vec<FP, Dim> diff;
+            FP dist_squared = 0.0;
+            for (size_t d = 0; d < Dim; ++d) {
+                diff[d] = pos[d][k] - pos[d][i];
+                dist_squared += diff[d] * diff[d];
+            }
+            if (dist_squared == 0)
+                continue;
+            FP factor, pair_potential;
+            law(G * mass[i] * mass[k], dist_squared, factor, pair_potential);
+            local_potential -= pair_potential;
+
+            for (size_t d = 0; d < Dim; ++d) {
+                forces[d][i] += factor * diff[d];
+                forces[d][k] -= factor * diff[d];
+            }
+        }
+    }
+}
+
+// Metodo output: scrittura collettiva con MPI-IO oppure un file per rank
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::output(size_t step) {
+    NBODY_PROFILE_SCOPE("output");
+    if (this->output_format == OutputFormat::BINARY) return output_binary(step);
+
+    std::ostringstream timestep_filename_stream;
+    timestep_filename_stream << this->output_filename_prefix;
+    if (output_mode == OutputMode::PER_RANK) {
+        timestep_filename_stream << "rank" << std::setfill('0') << std::setw(3) << rank << "-";
+    }
+    timestep_filename_stream << std::setfill('0') << std::setw(5) << step << ".csv";
+    const std::string timestep_filename = timestep_filename_stream.str();
+
+    // Formatta il blocco locale; l'header è scritto una sola volta
+    std::ostringstream chunk;
+    if (rank == 0 || output_mode == OutputMode::PER_RANK) {
+        chunk << "t";
+        for (size_t d = 0; d < Dim; ++d) chunk << ",x" << d;
+        for (size_t d = 0; d < Dim; ++d) chunk << ",v" << d;
+        chunk << ",m\n";
+    }
+    const auto &pos = particles.pos();
+    const auto &vel = particles.vel();
+    const FP *mass = particles.mass();
+    for (size_t i = 0; i < local_n; ++i) {
+        chunk << this->time[step];
+        for (size_t d = 0; d < Dim; ++d) chunk << "," << pos[d][i];
+        for (size_t d = 0; d < Dim; ++d) chunk << "," << vel[d][i];
+        chunk << "," << mass[i] << "\n";
+    }
+    const std::string content = chunk.str();
+
+    if (output_mode == OutputMode::PER_RANK) {
+        std::ofstream output_file(timestep_filename);
+        if (!output_file.is_open()) {
+            throw std::runtime_error("Error: Unable to open the output file!");
+        }
+        output_file << content;
+        return;
+    }
+
+    // Ogni rank scrive dopo i byte dei rank precedenti
+    long long length = static_cast<long long>(content.size());
+    long long file_offset = 0;
+    MPI_Exscan(&length, &file_offset, 1, MPI_LONG_LONG, MPI_SUM, comm);
+    if (rank == 0) file_offset = 0;
+
+    MPI_File file;
+    if (MPI_File_open(comm, timestep_filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &file) !=
+        MPI_SUCCESS) {
+        throw std::runtime_error("Error: Unable to open the output file!");
+    }
+    MPI_File_set_size(file, 0);
+    MPI_File_write_at_all(file, file_offset, content.data(), static_cast<int>(content.size()), MPI_CHAR,
+                          MPI_STATUS_IGNORE);
+    NBODY_PROFILE_COUNT("bytes written", content.size());
+    MPI_File_close(&file);
+}
+
+// Apre la traiettoria condivisa: il rank 0 scrive l'header, poi ogni rank imposta una vista del file che
+// espone, in ogni frame, solo il tempo (rank 0) e il proprio blocco di ogni componente. Dopo restart il file
+// esistente è troncato ai frame registrati nel checkpoint.
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::open_trajectory() {
+    const TrajectoryHeader header = make_trajectory_header<FP, Dim>(this->N);
+    if (resume_frames && rank == 0) check_trajectory_prefix(this->trajectory_filename, header, *resume_frames);
+    if (MPI_File_open(comm, this->trajectory_filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL,
+                      &trajectory_file) != MPI_SUCCESS) {
+        throw std::runtime_error("Error: Unable to open the output file!");
+    }
+    MPI_File_set_size(trajectory_file, static_cast<MPI_Offset>(
+            resume_frames ? header.header_bytes + *resume_frames * header.frame_bytes : 0));
+    if (rank == 0 && !resume_frames) {
+        MPI_File_write_at(trajectory_file, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+        NBODY_PROFILE_COUNT("bytes written", sizeof(header));
+    }
+
+    std::vector<int> block_lengths, displacements;
+    if (rank == 0) {
+        block_lengths.push_back(1);
+        displacements.push_back(0);
+    }
+    for (size_t component = 0; component < 2 * Dim + 1; ++component) {
+        block_lengths.push_back(static_cast<int>(local_n));
+        displacements.push_back(static_cast<int>(1 + component * this->N + offset));
+    }
+    MPI_Datatype blocks;
+    MPI_Type_indexed(static_cast<int>(block_lengths.size()), block_lengths.data(), displacements.data(),
+                     mpi_type<FP>(), &blocks);
+    MPI_Type_create_resized(blocks, 0, static_cast<MPI_Aint>(header.frame_bytes), &frame_type);
+    MPI_Type_commit(&frame_type);
+    MPI_Type_free(&blocks);
+    MPI_File_set_view(trajectory_file, header.header_bytes, mpi_type<FP>(), frame_type, "native", MPI_INFO_NULL);
+
+    frame_size = (rank == 0 ? 1 : 0) + (2 * Dim + 1) * local_n;
+    frame_buffers.assign(std::max<size_t>(this->output_queue_depth, 1), aligned_vector<FP>(frame_size));
+    frame_requests.assign(frame_buffers.size(), MPI_REQUEST_NULL);
+    frames_written = resume_frames.value_or(0);
+}
+
+// Snapshot binario. In COLLECTIVE il blocco locale è copiato in uno dei buffer del pool e scritto con una
+// scrittura collettiva non bloccante, che procede durante gli step successivi; il buffer è riusato solo dopo
+// il completamento della scrittura precedente (backpressure). In PER_RANK scrive il thread di I/O del rank.
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::output_binary(size_t step) {
+    if (output_mode == OutputMode::PER_RANK) {
+        if (!rank_trajectory.is_open()) {
+            std::ostringstream rank_filename;
+            rank_filename << this->output_filename_prefix << "rank" << std::setfill('0') << std::setw(3) << rank
+                          << ".traj";
+            rank_trajectory.open(rank_filename.str(), local_n, this->output_queue_depth, resume_frames);
+        }
+        rank_trajectory.write_frame(this->time[step], particles);
+        return;
+    }
+
+    if (trajectory_file == MPI_FILE_NULL) open_trajectory();
+
+    const size_t buffer = frames_written % frame_buffers.size();
+    MPI_Wait(&frame_requests[buffer], MPI_STATUS_IGNORE);
+
+    FP *frame = frame_buffers[buffer].data();
+    if (rank == 0) *frame++ = this->time[step];
+    for (size_t d = 0; d < Dim; ++d, frame += local_n) std::copy_n(particles.pos()[d], local_n, frame);
+    for (size_t d = 0; d < Dim; ++d, frame += local_n) std::copy_n(particles.vel()[d], local_n, frame);
+    std::copy_n(particles.mass(), local_n, frame);
+
+    // Gli offset della vista contano solo i valori visibili al rank
+    const MPI_Offset frame_offset = static_cast<MPI_Offset>(frames_written * frame_size);
+    NBODY_PROFILE_COUNT("bytes written", frame_size * sizeof(FP));
+    if (this->output_queue_depth == 0) {
+        MPI_File_write_at_all(trajectory_file, frame_offset, frame_buffers[buffer].data(),
+                              static_cast<int>(frame_size), mpi_type<FP>(), MPI_STATUS_IGNORE);
+    } else {
+        MPI_File_iwrite_at_all(trajectory_file, frame_offset, frame_buffers[buffer].data(),
+                               static_cast<int>(frame_size), mpi_type<FP>(), &frame_requests[buffer]);
+    }
+    ++frames_written;
+}
+
+template<std::floating_point FP, size_t Dim>
+void NBodyMPI<FP, Dim>::close_trajectory() {
+    if (trajectory_file != MPI_FILE_NULL) {
+        MPI_Waitall(static_cast<int>(frame_requests.size()), frame_requests.data(), MPI_STATUSES_IGNORE);
+        MPI_File_close(&trajectory_file);
+        MPI_Type_free(&frame_type);
+    }
+    rank_trajectory.close();
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class NBodyMPI<double, 1>;
+template class NBodyMPI<double, 2>;
+template class NBodyMPI<double, 3>;
+template class NBodyMPI<float, 1>;
+template class NBodyMPI<float, 2>;
+template class NBodyMPI<float, 3>;
@@ -0,0 +1,46 @@
+#include "diagnostics.hpp"
+#include <algorithm>
+#include <omp.h>
+
+// Le somme sono ridotte come array: valori[k] secondo l'ordine di Diagnostics::values()
+template<std::floating_point FP, size_t Dim>
+Diagnostics<FP, Dim> measure_diagnostics(const ParticleSystem<FP, Dim> &particles, FP potential_energy) {
+    constexpr size_t num_values = Diagnostics<FP, Dim>::num_values;
+    constexpr size_t momentum = 3, angular_momentum = momentum + Dim;
+    constexpr size_t mass_moment = angular_momentum + Diagnostics<FP, Dim>::num_planes;
+
+    const auto &pos = particles.pos();
+    const auto &vel = particles.vel();
+    const FP *mass = particles.mass();
+
+    FP sums[num_values] = {};
+#pragma omp parallel for schedule(static) reduction(+: sums[:num_values])
+    for (size_t i = 0; i < particles.size(); ++i) {
+        FP speed_squared = 0.0;
+        for (size_t d = 0; d < Dim; ++d) {
+            speed_squared += vel[d][i] * vel[d][i];
+            sums[momentum + d] += mass[i] * vel[d][i];
+            sums[mass_moment + d] += mass[i] * pos[d][i];
+        }
+        sums[0] += 0.5 * mass[i] * speed_squared;
+        sums[2] += mass[i];
+
+        size_t p = angular_momentum;
+        for (size_t a = 0; a < Dim; ++a)
+            for (size_t b = a + 1; b < Dim; ++b, ++p)
+                sums[p] += mass[i] * (pos[a][i] * vel[b][i] - pos[b][i] * vel[a][i]);
+    }
+    sums[1] = potential_energy;
+
+    std::array<FP, num_values> values;
+    std::copy_n(sums, num_values, values.begin());
+    return Diagnostics<FP, Dim>::from_values(values);
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template Diagnostics<double, 1> measure_diagnostics<double, 1>(const ParticleSystem<double, 1> &, double);
+template Diagnostics<double, 2> measure_diagnostics<double, 2>(const ParticleSystem<double, 2> &, double);
+template Diagnostics<double, 3> measure_diagnostics<double, 3>(const ParticleSystem<double, 3> &, double);
+template Diagnostics<float, 1> measure_diagnostics<float, 1>(const ParticleSystem<float, 1> &, float);
+template Diagnostics<float, 2> measure_diagnostics<float, 2>(const ParticleSystem<float, 2> &, float);
+template Diagnostics<float, 3> measure_diagnostics<float, 3>(const ParticleSystem<float, 3> &, float);
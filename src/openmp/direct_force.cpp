@@ -0,0 +1,99 @@
+#include "direct_force.hpp"
+#include <omp.h>
+
+// Il ciclo sulle coppie (q, k) sfrutta la terza legge di Newton: per evitare race condition sugli aggiornamenti
+// simmetrici delle forze su q e k, ogni thread accumula in un proprio buffer, ridotto alla fine.
+// Ogni riga è calcolata dal kernel vettoriale, un blocco di direct_tile_size() sorgenti alla volta: i thread
+// passano al blocco successivo senza attendersi, perché scrivono solo nei propri buffer.
+template<std::floating_point FP, size_t Dim>
+void DirectForce<FP, Dim>::compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) {
+    const size_t n = particles.size();
+    const size_t num_threads = omp_get_max_threads();
+
+    const auto pos = particles.pos().pointers();
+    const FP *mass = particles.mass();
+
+    // Buffer privati dei thread, layout SoA: [thread][dimensione][particella]
+    thread_forces.assign(num_threads * Dim * n, 0.0);
+    FP pair_potential = 0.0;
+    kernel.prepare(particles, G);
+    const FP force_unit = kernel.force_unit();
+
+    const size_t tile = direct_tile_size<FP, Dim>();
+
+#pragma omp parallel reduction(+: pair_potential)
+    {
+        std::array<FP *, Dim> local_forces;
+        for (size_t d = 0; d < Dim; ++d)
+            local_forces[d] = thread_forces.data() + (omp_get_thread_num() * Dim + d) * n;
+
+        // Il carico per riga è triangolare: schedulazione dinamica
+        for (size_t tile_begin = 0; tile_begin < n; tile_begin += tile) {
+            const size_t tile_end = std::min(n, tile_begin + tile);
+#pragma omp for schedule(dynamic, 16) nowait
+            for (size_t q = 0; q < tile_end - 1; ++q) {
+                Vec<FP, Dim> force_q{};
+                kernel.row(pos, mass, G, q, std::max(q + 1, tile_begin), tile_end, force_q, pair_potential,
+                           local_forces);
+
+                for (size_t d = 0; d < Dim; ++d) local_forces[d][q] += force_q[d];
+            }
+        }
+
+        // Riduzione dei buffer, dopo che tutti i thread hanno completato i blocchi
+#pragma omp barrier
+#pragma omp for schedule(static)
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t d = 0; d < Dim; ++d) {
+                FP force = 0.0;
+                for (size_t t = 0; t < num_threads; ++t) force += thread_forces[(t * Dim + d) * n + i];
+                forces[d][i] = force * force_unit;
+            }
+        }
+    }
+    this->potential = -pair_potential * kernel.potential_unit();
+    NBODY_PROFILE_COUNT("pair interactions", n * (n - 1) / 2);
+}
+
+// Forze sulle sole particelle attive: ogni riga somma tutte le sorgenti, senza reazione
+template<std::floating_point FP, size_t Dim>
+void DirectForce<FP, Dim>::compute_active_forces(const ParticleSystem<FP, Dim> &particles,
+                                                 VectorField<FP, Dim> &forces, const std::vector<uint32_t> &active) {
+    const auto pos = particles.pos().pointers();
+    const FP *mass = particles.mass();
+
+    FP pair_potential = 0.0;
+    kernel.prepare(particles, G);
+    const FP force_unit = kernel.force_unit();
+    const size_t tile = direct_tile_size<FP, Dim>();
+
+    // Ogni thread calcola le stesse particelle attive in tutti i blocchi (schedulazione statica)
+#pragma omp parallel reduction(+: pair_potential)
+    for (size_t tile_begin = 0; tile_begin < particles.size(); tile_begin += tile) {
+        const size_t tile_end = std::min(particles.size(), tile_begin + tile);
+#pragma omp for schedule(static) nowait
+        for (size_t k = 0; k < active.size(); ++k) {
+            const uint32_t q = active[k];
+            Vec<FP, Dim> force_q{};
+            kernel.sum(pos, mass, G, q, tile_begin, tile_end, force_q, pair_potential);
+
+            for (size_t d = 0; d < Dim; ++d) {
+                if (tile_begin == 0) forces[d][q] = force_q[d] * force_unit;
+                else forces[d][q] += force_q[d] * force_unit;
+            }
+        }
+    }
+
+    // Se tutte le particelle sono attive ogni coppia è contata due volte
+    NBODY_PROFILE_COUNT("pair interactions", active.size() * particles.size());
+    if (active.size() == particles.size()) this->potential = -pair_potential / 2 * kernel.potential_unit();
+    else this->potential.reset();
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class DirectForce<double, 1>;
+template class DirectForce<double, 2>;
+template class DirectForce<double, 3>;
+template class DirectForce<float, 1>;
+template class DirectForce<float, 2>;
+template class DirectForce<float, 3>;
@@ -0,0 +1,38 @@
+#include "n_body.hpp"
+#include <omp.h>
+
+template<std::floating_point FP, size_t Dim>
+FP NBody<FP, Dim>::calculate_potential_energy() {
+    FP potential_energy = 0;
+
+    const auto &pos = particles.pos();
+    const FP *mass = particles.mass();
+
+    with_interaction_law<FP>(interaction, [&](const auto &law) {
+#pragma omp parallel for schedule(dynamic, 16) reduction(+:potential_energy)
+        for (size_t i = 0; i < this->N; ++i) {
+            for (size_t j = i + 1; j < this->N; ++j) {
+                FP dist_squared = 0.0;
+                for (size_t d = 0; d < Dim; ++d) {
+                    FP diff = pos[d][j] - pos[d][i];
+                    dist_squared += diff * diff;
+                }
+                if (dist_squared == 0) continue;
+
+                FP factor, pair_potential;
+                law(this->G * mass[i] * mass[j], dist_squared, factor, pair_potential);
+                potential_energy -= pair_potential;
+            }
+        }
+    });
+
+    return potential_energy;
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class NBody<double, 1>;
+template class NBody<double, 2>;
+template class NBody<double, 3>;
+template class NBody<float, 1>;
+template class NBody<float, 2>;
+template class NBody<float, 3>;
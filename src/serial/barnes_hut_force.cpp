@@ -0,0 +1,54 @@
+#include "barnes_hut_force.hpp"
+
+template<std::floating_point FP, size_t Dim>
+void BarnesHutForce<FP, Dim>::compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) {
+    if (particles.size() == 0) return;
+    tree.build(particles, leaf_size);
+    const auto &order = tree.order();
+
+    const auto pos = particles.pos().pointers();
+    const FP *mass = particles.mass();
+
+    // Le particelle sono visitate in ordine di albero: bersagli consecutivi percorrono gli stessi nodi
+    FP pair_potential = 0.0;
+    with_interaction_law<FP>(interaction, [&](const auto &law) {
+        for (size_t k = 0; k < order.size(); ++k) {
+            const uint32_t i = order[k];
+            const Vec<FP, Dim> force = walk(law, pos, mass, i, pair_potential);
+            for (size_t d = 0; d < Dim; ++d) forces[d][i] = force[d];
+        }
+    });
+    this->potential = -pair_potential / 2; // Ogni interazione è contata da entrambe le parti
+}
+
+// Forze sulle sole particelle attive: l'albero contiene comunque tutte le particelle
+template<std::floating_point FP, size_t Dim>
+void BarnesHutForce<FP, Dim>::compute_active_forces(const ParticleSystem<FP, Dim> &particles,
+                                                    VectorField<FP, Dim> &forces,
+                                                    const std::vector<uint32_t> &active) {
+    if (particles.size() == 0) return;
+    tree.build(particles, leaf_size);
+
+    const auto pos = particles.pos().pointers();
+    const FP *mass = particles.mass();
+
+    FP pair_potential = 0.0;
+    with_interaction_law<FP>(interaction, [&](const auto &law) {
+        for (size_t k = 0; k < active.size(); ++k) {
+            const uint32_t i = active[k];
+            const Vec<FP, Dim> force = walk(law, pos, mass, i, pair_potential);
+            for (size_t d = 0; d < Dim; ++d) forces[d][i] = force[d];
+        }
+    });
+
+    if (active.size() == particles.size()) this->potential = -pair_potential / 2;
+    else this->potential.reset();
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class BarnesHutForce<double, 1>;
+template class BarnesHutForce<double, 2>;
+template class BarnesHutForce<double, 3>;
+template class BarnesHutForce<float, 1>;
+template class BarnesHutForce<float, 2>;
+template class BarnesHutForce<float, 3>;
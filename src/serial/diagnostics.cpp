@@ -0,0 +1,37 @@
+#include "diagnostics.hpp"
+
+template<std::floating_point FP, size_t Dim>
+Diagnostics<FP, Dim> measure_diagnostics(const ParticleSystem<FP, Dim> &particles, FP potential_energy) {
+    Diagnostics<FP, Dim> diagnostics;
+    diagnostics.potential_energy = potential_energy;
+
+    const auto &pos = particles.pos();
+    const auto &vel = particles.vel();
+    const FP *mass = particles.mass();
+
+    for (size_t i = 0; i < particles.size(); ++i) {
+        FP speed_squared = 0.0;
+        for (size_t d = 0; d < Dim; ++d) {
+            speed_squared += vel[d][i] * vel[d][i];
+            diagnostics.momentum[d] += mass[i] * vel[d][i];
+            diagnostics.mass_moment[d] += mass[i] * pos[d][i];
+        }
+        diagnostics.kinetic_energy += 0.5 * mass[i] * speed_squared;
+        diagnostics.mass += mass[i];
+
+        size_t p = 0;
+        for (size_t a = 0; a < Dim; ++a)
+            for (size_t b = a + 1; b < Dim; ++b, ++p)
+                diagnostics.angular_momentum[p] += mass[i] * (pos[a][i] * vel[b][i] - pos[b][i] * vel[a][i]);
+    }
+
+    return diagnostics;
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template Diagnostics<double, 1> measure_diagnostics<double, 1>(const ParticleSystem<double, 1> &, double);
+template Diagnostics<double, 2> measure_diagnostics<double, 2>(const ParticleSystem<double, 2> &, double);
+template Diagnostics<double, 3> measure_diagnostics<double, 3>(const ParticleSystem<double, 3> &, double);
+template Diagnostics<float, 1> measure_diagnostics<float, 1>(const ParticleSystem<float, 1> &, float);
+template Diagnostics<float, 2> measure_diagnostics<float, 2>(const ParticleSystem<float, 2> &, float);
+template Diagnostics<float, 3> measure_diagnostics<float, 3>(const ParticleSystem<float, 3> &, float);
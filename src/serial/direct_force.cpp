@@ -0,0 +1,73 @@
+#include "direct_force.hpp"
+
+// Il ciclo sulle coppie (q, k) sfrutta la terza legge di Newton; ogni riga è calcolata dal kernel vettoriale.
+// Le sorgenti k sono divise in blocchi di direct_tile_size() particelle, attraversati da tutte le righe q < k.
+template<std::floating_point FP, size_t Dim>
+void DirectForce<FP, Dim>::compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) {
+    const size_t n = particles.size();
+    forces.fill(0.0);
+
+    const auto pos = particles.pos().pointers();
+    const auto force = forces.pointers();
+    const FP *mass = particles.mass();
+
+    FP pair_potential = 0.0;
+    kernel.prepare(particles, G);
+    const size_t tile = direct_tile_size<FP, Dim>();
+    for (size_t tile_begin = 0; tile_begin < n; tile_begin += tile) {
+        const size_t tile_end = std::min(n, tile_begin + tile);
+        for (size_t q = 0; q + 1 < tile_end; ++q) {
+            Vec<FP, Dim> force_q{};
+            kernel.row(pos, mass, G, q, std::max(q + 1, tile_begin), tile_end, force_q, pair_potential, force);
+
+            for (size_t d = 0; d < Dim; ++d) force[d][q] += force_q[d];
+        }
+    }
+
+    // In precisione mista il kernel accumula in unità scalate
+    if (kernel.precision() == KernelPrecision::MIXED) {
+        for (size_t d = 0; d < Dim; ++d)
+            for (size_t i = 0; i < n; ++i) force[d][i] *= kernel.force_unit();
+    }
+    this->potential = -pair_potential * kernel.potential_unit();
+    NBODY_PROFILE_COUNT("pair interactions", n * (n - 1) / 2);
+}
+
+// Forze sulle sole particelle attive: ogni riga somma tutte le sorgenti, senza reazione
+template<std::floating_point FP, size_t Dim>
+void DirectForce<FP, Dim>::compute_active_forces(const ParticleSystem<FP, Dim> &particles,
+                                                 VectorField<FP, Dim> &forces, const std::vector<uint32_t> &active) {
+    const auto pos = particles.pos().pointers();
+    const FP *mass = particles.mass();
+
+    FP pair_potential = 0.0;
+    kernel.prepare(particles, G);
+    const FP force_unit = kernel.force_unit();
+    for (const uint32_t q: active)
+        for (size_t d = 0; d < Dim; ++d) forces[d][q] = 0.0;
+
+    const size_t tile = direct_tile_size<FP, Dim>();
+    for (size_t tile_begin = 0; tile_begin < particles.size(); tile_begin += tile) {
+        const size_t tile_end = std::min(particles.size(), tile_begin + tile);
+        for (size_t k = 0; k < active.size(); ++k) {
+            const uint32_t q = active[k];
+            Vec<FP, Dim> force_q{};
+            kernel.sum(pos, mass, G, q, tile_begin, tile_end, force_q, pair_potential);
+
+            for (size_t d = 0; d < Dim; ++d) forces[d][q] += force_q[d] * force_unit;
+        }
+    }
+
+    // Se tutte le particelle sono attive ogni coppia è contata due volte
+    NBODY_PROFILE_COUNT("pair interactions", active.size() * particles.size());
+    if (active.size() == particles.size()) this->potential = -pair_potential / 2 * kernel.potential_unit();
+    else this->potential.reset();
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class DirectForce<double, 1>;
+template class DirectForce<double, 2>;
+template class DirectForce<double, 3>;
+template class DirectForce<float, 1>;
+template class DirectForce<float, 2>;
+template class DirectForce<float, 3>;
@@ -0,0 +1,58 @@
+#include "fmm_force.hpp"
+
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::compute_forces(const ParticleSystem<FP, Dim> &particles, VectorField<FP, Dim> &forces) {
+    if (particles.size() == 0) return;
+    tree.build(particles, leaf_size);
+    gather(particles);
+
+    {
+        NBODY_PROFILE_SCOPE("fmm upward");
+        upward_pass();
+    }
+    {
+        NBODY_PROFILE_SCOPE("fmm traversal");
+        locals.assign(multipoles.size(), 0.0);
+        traverse(0, 0);
+    }
+    {
+        NBODY_PROFILE_SCOPE("fmm downward");
+        downward_pass();
+    }
+    scatter(forces);
+}
+
+template<std::floating_point FP, size_t Dim>
+void FmmForce<FP, Dim>::traverse(uint32_t source, uint32_t target) {
+    const auto &nodes = tree.nodes();
+    const Node &s = nodes[source], &t = nodes[target];
+
+    // Interazione di una cella con se stessa: tutte le coppie di figli
+    if (source == target) {
+        if (t.is_leaf()) return p2p(source, target);
+        for (uint32_t c = t.first_child; c < t.first_child + t.child_count; ++c)
+            for (uint32_t k = t.first_child; k < t.first_child + t.child_count; ++k)
+                traverse(k, c);
+        return;
+    }
+
+    if (well_separated(s, t)) return m2l(source, target);
+    if (s.is_leaf() && t.is_leaf()) return p2p(source, target);
+
+    // Si divide la cella più grande
+    if (s.is_leaf() || (!t.is_leaf() && t.radius >= s.radius)) {
+        for (uint32_t c = t.first_child; c < t.first_child + t.child_count; ++c)
+            traverse(source, c);
+    } else {
+        for (uint32_t c = s.first_child; c < s.first_child + s.child_count; ++c)
+            traverse(c, target);
+    }
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template class FmmForce<double, 1>;
+template class FmmForce<double, 2>;
+template class FmmForce<double, 3>;
+template class FmmForce<float, 1>;
+template class FmmForce<float, 2>;
+template class FmmForce<float, 3>;
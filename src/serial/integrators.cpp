@@ -0,0 +1,119 @@
+#include "euler_implicit_integrator.hpp"
+#include <algorithm>
+
+template<std::floating_point FP, size_t Dim>
+void kick(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces, FP delta_t) {
+    const FP *mass = particles.mass();
+    for (size_t d = 0; d < Dim; ++d) {
+        FP *vel = particles.vel()[d];
+        const FP *force = forces[d];
+        for (size_t i = 0; i < particles.size(); ++i) {
+            vel[i] += delta_t * force[i] / mass[i];
+        }
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void drift(ParticleSystem<FP, Dim> &particles, FP delta_t) {
+    for (size_t d = 0; d < Dim; ++d) {
+        FP *pos = particles.pos()[d];
+        const FP *vel = particles.vel()[d];
+        for (size_t i = 0; i < particles.size(); ++i) {
+            pos[i] += delta_t * vel[i];
+        }
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void drift_accelerated(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces, FP delta_t) {
+    const FP *mass = particles.mass();
+    for (size_t d = 0; d < Dim; ++d) {
+        FP *pos = particles.pos()[d];
+        const FP *vel = particles.vel()[d];
+        const FP *force = forces[d];
+        for (size_t i = 0; i < particles.size(); ++i) {
+            pos[i] += delta_t * vel[i] + delta_t * delta_t / 2 * force[i] / mass[i];
+        }
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+void kick_active(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces,
+                 const std::vector<uint32_t> &active, const std::vector<FP> &delta_t) {
+    const FP *mass = particles.mass();
+    for (size_t d = 0; d < Dim; ++d) {
+        FP *vel = particles.vel()[d];
+        const FP *force = forces[d];
+        for (size_t k = 0; k < active.size(); ++k) {
+            const uint32_t i = active[k];
+            vel[i] += delta_t[k] * force[i] / mass[i];
+        }
+    }
+}
+
+template<std::floating_point FP, size_t Dim>
+FP EulerImplicitIntegrator<FP, Dim>::update(ParticleSystem<FP, Dim> &particles, const VectorField<FP, Dim> &forces,
+                                            FP delta_t, FP &displacement) {
+    const FP *mass = particles.mass();
+    FP change = 0.0;
+    displacement = 0.0;
+    for (size_t d = 0; d < Dim; ++d) { // Itera su ogni dimensione
+        FP *pos = particles.pos()[d];
+        FP *vel = particles.vel()[d];
+        const FP *force = forces[d];
+        for (size_t i = 0; i < particles.size(); ++i) { // Itera su ogni particella
+            // Velocità e posizione con l'accelerazione nella stima corrente di x'
+            vel[i] = start_vel[d][i] + delta_t * force[i] / mass[i];
+            const FP new_pos = start_pos[d][i] + delta_t * vel[i];
+
+            change = std::max(change, std::abs(new_pos - pos[i]));
+            displacement = std::max(displacement, std::abs(new_pos - start_pos[d][i]));
+            pos[i] = new_pos;
+        }
+    }
+    return change;
+}
+
+// Specializzazione esplicita per i tipi double e float, nelle dimensioni supportate
+template void kick<double, 1>(ParticleSystem<double, 1> &, const VectorField<double, 1> &, double);
+template void kick<double, 2>(ParticleSystem<double, 2> &, const VectorField<double, 2> &, double);
+template void kick<double, 3>(ParticleSystem<double, 3> &, const VectorField<double, 3> &, double);
+template void drift<double, 1>(ParticleSystem<double, 1> &, double);
+template void drift<double, 2>(ParticleSystem<double, 2> &, double);
+template void drift<double, 3>(ParticleSystem<double, 3> &, double);
+template void drift_accelerated<double, 1>(ParticleSystem<double, 1> &, const VectorField<double, 1> &,
+                                            double);
+template void drift_accelerated<double, 2>(ParticleSystem<double, 2> &, const VectorField<double, 2> &,
+                                            double);
+template void drift_accelerated<double, 3>(ParticleSystem<double, 3> &, const VectorField<double, 3> &,
+                                            double);
+template void kick_active<double, 1>(ParticleSystem<double, 1> &, const VectorField<double, 1> &,
+                                      const std::vector<uint32_t> &, const std::vector<double> &);
+template void kick_active<double, 2>(ParticleSystem<double, 2> &, const VectorField<double, 2> &,
+                                      const std::vector<uint32_t> &, const std::vector<double> &);
+template void kick_active<double, 3>(ParticleSystem<double, 3> &, const VectorField<double, 3> &,
+                                      const std::vector<uint32_t> &, const std::vector<double> &);
+template class EulerImplicitIntegrator<double, 1>;
+template class EulerImplicitIntegrator<double, 2>;
+template class EulerImplicitIntegrator<double, 3>;
+template void kick<float, 1>(ParticleSystem<float, 1> &, const VectorField<float, 1> &, float);
+template void kick<float, 2>(ParticleSystem<float, 2> &, const VectorField<float, 2> &, float);
+template void kick<float, 3>(ParticleSystem<float, 3> &, const VectorField<float, 3> &, float);
+template void drift<float, 1>(ParticleSystem<float, 1> &, float);
+template void drift<float, 2>(ParticleSystem<float, 2> &, float);
+template void drift<float, 3>(ParticleSystem<float, 3> &, float);
+template void drift_accelerated<float, 1>(ParticleSystem<float, 1> &, const VectorField<float, 1> &,
+                                           float);
+template void drift_accelerated<float, 2>(ParticleSystem<float, 2> &, const VectorField<float, 2> &,
+                                           float);
+template void drift_accelerated<float, 3>(ParticleSystem<float, 3> &, const VectorField<float, 3> &,
+                                           float);
+template void kick_active<float, 1>(ParticleSystem<float, 1> &, const VectorField<float, 1> &,
+                                     const std::vector<uint32_t> &, const std::vector<float> &);
+template void kick_active<float, 2>(ParticleSystem<float, 2> &, const VectorField<float, 2> &,
+                                     const std::vector<uint32_t> &, const std::vector<float> &);
+template void kick_active<float, 3>(ParticleSystem<float, 3> &, const VectorField<float, 3> &,
+                                     const std::vector<uint32_t> &, const std::vector<float> &);
+template class EulerImplicitIntegrator<float, 1>;
+template class EulerImplicitIntegrator<float, 2>;
+template class EulerImplicitIntegrator<float, 3>;
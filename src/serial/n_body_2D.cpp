@@ -1,4 +0,0 @@
-#include "n_body_2D.hpp"
-
-// Specializzazione esplicita per il tipo double
-template class NBody2D<double>;
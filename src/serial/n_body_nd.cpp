@@ -1 +0,0 @@
-#include "n_body_nd.hpp"
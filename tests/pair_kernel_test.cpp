@@ -0,0 +1,67 @@
+#include "direct_force.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+
+// Confronto dei kernel vettoriali (precisione piena e ridotta) con quello scalare, su posizioni distribuite su
+// molti ordini di grandezza: le distanze al quadrato escono dall'intervallo dei float in entrambe le direzioni.
+
+static constexpr double tolerance = 1e-10; // Massimo errore relativo della forza su una particella
+
+template<size_t Dim>
+static ParticleSystem<double, Dim> wide_range_particles(size_t n) {
+    std::mt19937_64 generator(42);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0), exponent(-22.0, 22.0), mass(0.5, 2.0);
+    ParticleSystem<double, Dim> particles(n);
+    for (size_t i = 0; i < n; ++i) {
+        const double scale = std::pow(10.0, exponent(generator));
+        for (size_t d = 0; d < Dim; ++d) particles.pos()[d][i] = scale * unit(generator);
+        particles.mass()[i] = mass(generator);
+    }
+    return particles;
+}
+
+template<size_t Dim>
+static bool check(const Interaction &interaction) {
+    const ParticleSystem<double, Dim> particles = wide_range_particles<Dim>(67); // Con un resto nei cicli vettoriali
+    std::vector<uint32_t> all(particles.size());
+    std::iota(all.begin(), all.end(), 0);
+    const double G = 6.673e-11;
+
+    VectorField<double, Dim> reference(particles.size()), forces(particles.size());
+    DirectForce<double, Dim>(G, PairKernel<double, Dim>(SimdIsa::SCALAR, KernelPrecision::FULL, interaction))
+            .compute_forces(particles, reference);
+
+    bool passed = true;
+    const SimdIsa supported = detect_simd_isa();
+    for (SimdIsa isa: {SimdIsa::SCALAR, SimdIsa::AVX2, SimdIsa::AVX512}) {
+        if (isa > supported) continue;
+        for (KernelPrecision precision: {KernelPrecision::FULL, KernelPrecision::REDUCED}) {
+            DirectForce<double, Dim> direct(G, PairKernel<double, Dim>(isa, precision, interaction));
+            for (bool active: {false, true}) {
+                if (active) direct.compute_active_forces(particles, forces, all);
+                else direct.compute_forces(particles, forces);
+
+                const double error = compare_forces(reference, forces).max_relative;
+                const bool ok = error <= tolerance;
+                passed = passed && ok;
+                std::cout << (ok ? "ok    " : "FAILED") << " " << Dim << "D " << interaction.name() << ", "
+                          << to_string(isa) << (precision == KernelPrecision::REDUCED ? " reduced" : "")
+                          << (active ? " (active)" : "") << ": max relative error " << error << "\n";
+            }
+        }
+    }
+    return passed;
+}
+
+int main() {
+    bool passed = true;
+    for (const Interaction &interaction: {Interaction(), Interaction(Softening::PLUMMER, 1e-30)}) {
+        passed = check<1>(interaction) && passed;
+        passed = check<2>(interaction) && passed;
+        passed = check<3>(interaction) && passed;
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
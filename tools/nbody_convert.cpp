@@ -0,0 +1,66 @@
+#include "input_reader.hpp"
+#include "trajectory.hpp"
+#include "json.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Conversione di un file di input JSON con le particelle in linea in un file di configurazione che rimanda a un
+// file binario di particelle (formato della traiettoria, un solo frame a t = 0). Il file binario si legge con
+// una mappatura in memoria, senza analisi del testo; con --float i valori sono salvati a 32 bit.
+
+using json = nlohmann::json;
+
+template<std::floating_point FP, size_t Dim>
+static size_t convert(const std::string &input_file, const std::string &output_file,
+                      const std::string &particles_file) {
+    ParticleSystem<FP, Dim> particles;
+    json config = read_input(input_file, particles);
+
+    TrajectoryWriter<FP, Dim> writer;
+    writer.open(particles_file, particles.size());
+    writer.write_frame(FP(0.0), particles);
+    writer.close();
+
+    // Il percorso del file di particelle è relativo alla cartella del file di configurazione
+    const std::filesystem::path output_directory = std::filesystem::absolute(output_file).parent_path();
+    config["particles_file"] = std::filesystem::relative(std::filesystem::absolute(particles_file),
+                                                         output_directory).string();
+    std::ofstream output(output_file);
+    if (!output.is_open()) throw std::runtime_error("Error: Unable to open " + output_file);
+    output << config.dump(2) << "\n";
+    return particles.size();
+}
+
+template<std::floating_point FP>
+static size_t convert(size_t dimensions, const std::string &input_file, const std::string &output_file,
+                      const std::string &particles_file) {
+    switch (dimensions) {
+        case 1: return convert<FP, 1>(input_file, output_file, particles_file);
+        case 2: return convert<FP, 2>(input_file, output_file, particles_file);
+        case 3: return convert<FP, 3>(input_file, output_file, particles_file);
+    }
+    throw std::invalid_argument("Unsupported problem dimension: " + std::to_string(dimensions));
+}
+
+int main(int argc, char *argv[]) {
+    const bool single_precision = argc == 5 && std::string(argv[4]) == "--float";
+    if (argc != 4 && !single_precision) {
+        std::cerr << "Usage: " << argv[0] << " <input.json> <output.json> <particles-file> [--float]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const size_t dimensions = read_input_dimensions(argv[1]);
+        const size_t n = single_precision ? convert<float>(dimensions, argv[1], argv[2], argv[3])
+                                          : convert<double>(dimensions, argv[1], argv[2], argv[3]);
+        std::cout << "Converted " << n << " particles (" << dimensions << "D) to '" << argv[3]
+                  << "', configuration in '" << argv[2] << "'\n";
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
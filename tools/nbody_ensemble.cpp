@@ -0,0 +1,113 @@
+#include "ensemble.hpp"
+#include "input_reader.hpp"
+#include "json.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Esecuzione di un insieme di simulazioni indipendenti (vedi ensemble.hpp) in un solo processo: i file di input
+// sono quelli di una cartella o di un manifest, i thread del pool integrano un sistema ciascuno alla volta.
+// I risultati sono scritti in {output}.csv (riepilogo) e {output}-final.csv (stati finali).
+
+using json = nlohmann::json;
+
+struct EnsembleOptions {
+    std::string inputs;
+    std::string output = "./output/ensemble";
+    std::string precision = "double";
+    size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    json overrides = json::object(); // Chiavi che sostituiscono quelle di ogni file di input
+};
+
+static const char usage[] = " <input-directory|manifest> [--output <prefix>] [--threads <n>]"
+                            " [--precision float|double] [--engine direct|barnes-hut|fmm] [--integrator <name>]";
+
+static EnsembleOptions parse_options(int argc, char *argv[]) {
+    EnsembleOptions options;
+    for (int a = 1; a < argc; ++a) {
+        const std::string option = argv[a];
+        if (option.rfind("--", 0) != 0) {
+            if (!options.inputs.empty()) throw std::invalid_argument("Unexpected argument: " + option);
+            options.inputs = option;
+            continue;
+        }
+        if (a + 1 >= argc) throw std::invalid_argument("Missing value for " + option);
+        const std::string value = argv[++a];
+        if (option == "--output") options.output = value;
+        else if (option == "--threads") options.threads = std::stoul(value);
+        else if (option == "--precision") options.precision = value;
+        else if (option == "--engine") options.overrides["force_engine"] = value;
+        else if (option == "--integrator") options.overrides["integrator"] = value;
+        else throw std::invalid_argument("Unknown option: " + option);
+    }
+    if (options.inputs.empty()) throw std::invalid_argument("Missing the input directory or manifest");
+    if (options.threads == 0) throw std::invalid_argument("--threads must be positive");
+    if (options.precision != "double" && options.precision != "float") {
+        throw std::invalid_argument("Unknown precision: " + options.precision);
+    }
+    return options;
+}
+
+template<std::floating_point FP, size_t Dim>
+static int run(const std::vector<std::string> &inputs, const EnsembleOptions &options) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+
+    Ensemble<FP, Dim> ensemble(inputs, options.overrides);
+    WorkStealingPool pool(options.threads);
+    ensemble.run(pool);
+    ensemble.write_summary(options.output + ".csv");
+    ensemble.write_final_states(options.output + "-final.csv");
+
+    const double wall = std::chrono::duration<double>(clock::now() - start).count();
+    std::cout << "Ran " << ensemble.size() << " " << Dim << "D system(s) (" << 8 * sizeof(FP) << "-bit) on "
+              << pool.size() << " thread(s) in " << wall << " s (" << ensemble.simulation_time()
+              << " s of simulation, " << pool.steal_count() << " steal(s)); summary in '" << options.output
+              << ".csv', final states in '" << options.output << "-final.csv'\n";
+    if (ensemble.failures() > 0) {
+        std::cerr << ensemble.failures() << " system(s) failed: see the status column of the summary" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// La dimensione dell'ensemble è quella del primo file leggibile e di dimensione supportata: i file precedenti e i
+// sistemi di dimensione diversa risultano in errore nel riepilogo. Se nessun file è adatto l'ensemble è eseguito
+// comunque (in 3D), per registrare l'errore di ciascuno.
+template<std::floating_point FP>
+static int run(const std::vector<std::string> &inputs, const EnsembleOptions &options) {
+    for (const std::string &input: inputs) {
+        size_t dimensions = 0;
+        try {
+            dimensions = read_input_dimensions(input);
+        } catch (const std::exception &) {
+            continue; // L'errore è riportato dal caricamento del sistema
+        }
+        switch (dimensions) {
+            case 1: return run<FP, 1>(inputs, options);
+            case 2: return run<FP, 2>(inputs, options);
+            case 3: return run<FP, 3>(inputs, options);
+        }
+    }
+    return run<FP, 3>(inputs, options);
+}
+
+int main(int argc, char *argv[]) {
+    EnsembleOptions options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << "\nUsage: " << argv[0] << usage << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try {
+        const std::vector<std::string> inputs = list_ensemble_inputs(options.inputs);
+        return options.precision == "float" ? run<float>(inputs, options) : run<double>(inputs, options);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}